@@ -16,6 +16,7 @@
 #include "txbase/math/color.h"
 #include "txbase/math/geometry.h"
 #include "txbase/math/matrix.h"
+#include "txbase/math/affine.h"
 #include "txbase/math/quaternion.h"
 #include "txbase/math/random.h"
 #include "txbase/math/ray.h"
@@ -47,4 +48,5 @@ namespace TX
 		struct Input;
 	}
 	class Timer;
+	class MemoryArena;
 }
@@ -5,7 +5,12 @@ namespace TX
 {
 	static Rect NullClipRect(-1e5f, -1e5f, 1e5f, 1e5f);
 
-	DrawList::DrawList(){
+	DrawList::DrawList(MemoryArena *arena) :
+		cmdBuf(arena),
+		idxBuf(arena),
+		vtxBuf(arena),
+		path(arena),
+		clipRectStack(arena){
 		vtxCurrIdx = 0;
 		idxPtr = idxBuf.data();
 		vtxPtr = vtxBuf.data();
@@ -21,6 +26,14 @@ namespace TX
 		clipRectStack.clear();
 		PathClear();
 	}
+	void DrawList::Reset(MemoryArena *arena){
+		Clear();
+		ResetArenaVector(cmdBuf, arena);
+		ResetArenaVector(idxBuf, arena);
+		ResetArenaVector(vtxBuf, arena);
+		ResetArenaVector(path, arena);
+		ResetArenaVector(clipRectStack, arena);
+	}
 	void DrawList::AddDrawCmd(){
 		DrawCmd cmd;
 		cmd.idxCount = 0;
@@ -4,6 +4,7 @@
 #include "txbase/math/geometry.h"
 #include "txbase/math/color.h"
 #include "fontmap.h"
+#include "txbase/sys/memory.h"
 
 namespace TX
 {
@@ -18,19 +19,27 @@ namespace TX
 		Vec2 uv;
 		Color	col;
 	};
+	/// <summary>
+	/// Geometry of a frame. The buffers allocate from a frame arena if one is given, see Reset().
+	/// </summary>
 	struct DrawList{
-		std::vector<DrawCmd>	cmdBuf;
-		std::vector<DrawIdx>	idxBuf;
-		std::vector<DrawVert>	vtxBuf;
+		ArenaVector<DrawCmd>	cmdBuf;
+		ArenaVector<DrawIdx>	idxBuf;
+		ArenaVector<DrawVert>	vtxBuf;
 
 		DrawIdx					vtxCurrIdx;
 		DrawIdx*				idxPtr;
 		DrawVert*				vtxPtr;
-		std::vector<Vec2>	path;
-		std::vector<Rect>		clipRectStack;
+		ArenaVector<Vec2>		path;
+		ArenaVector<Rect>		clipRectStack;
 
-		DrawList();
+		DrawList(MemoryArena *arena = nullptr);
 		void Clear();
+		/// <summary>
+		/// Clears the list and drops the buffers, which then allocate from the arena (or the heap if null).
+		/// Must be called before the arena of the previous frame is reused.
+		/// </summary>
+		void Reset(MemoryArena *arena);
 		void AddDrawCmd();
 		void UpdateClipRect();
 		void PushClipRect(const Rect& rect);
@@ -14,7 +14,7 @@ namespace TX { namespace UI { namespace GUI {
 		bool			folded;
 		float			contentHeight;
 		float			scroll;
-		void Reset(){ accessed = false; drawList.Clear(); }
+		void Reset(MemoryArena *frameArena){ accessed = false; drawList.Reset(frameArena); }
 		const Rect& GetClipRect(){ return drawList.clipRectStack.back(); }
 		static uint32_t GetID(const std::string& name){
 			// sdbm
@@ -25,8 +25,9 @@ namespace TX { namespace UI { namespace GUI {
 			return hash;
 		}
 	public:
-		Window(uint32_t id) :
+		Window(uint32_t id, MemoryArena *frameArena = nullptr) :
 			id(id),
+			drawList(frameArena),
 			accessed(false),
 			folded(false),
 			contentHeight(1.f),
@@ -57,6 +58,7 @@ namespace TX { namespace UI { namespace GUI {
 		Input*					inputPtr;
 		Vec2					cursorBackup;	// used to disable cursor if it's outside the current window
 		std::vector<Window*>	windows;
+		MemoryArena*			frameArena = nullptr;	// per-frame buffers of the draw lists
 		Widget					current;
 		Widget					hot;
 		Widget					hotToBe;
@@ -241,7 +243,7 @@ namespace TX { namespace UI { namespace GUI {
 				}
 			}
 			if (!result) {
-				windows.push_back(new Window(id));
+				windows.push_back(new Window(id, frameArena));
 				result = windows.back();
 			}
 			result->accessed = true;
@@ -384,14 +386,15 @@ namespace TX { namespace UI { namespace GUI {
 		G.program = G.vertShader = G.fragShader = 0;
 	}
 
-	void BeginFrame(Input& input){
+	void BeginFrame(Input& input, MemoryArena *frameArena){
+		G.frameArena = frameArena;
 		G.inputPtr = &input;
 		G.input = input;
 		G.cursorBackup = InvalidCursor;
 		G.current.Reset();
 		G.hot = G.hotToBe;
 		G.hotToBe.Reset();
-		for (Window *w : G.windows) w->Reset();
+		for (Window *w : G.windows) w->Reset(frameArena);
 	}
 	void EndFrame(){
 		G.current.Reset(G.windows[0]);
@@ -63,7 +63,11 @@ namespace TX {
 			Style& GetStyle();
 			void Init(FontMap& font);
 			void Shutdown();
-			void BeginFrame(Input& input);
+			/// <summary>
+			/// Starts a frame. The draw lists allocate from the frame arena if one is given (see
+			/// Application::GetFrameArena()); it must not be freed before EndFrame().
+			/// </summary>
+			void BeginFrame(Input& input, MemoryArena *frameArena = nullptr);
 			void EndFrame();
 			bool BeginWindow(const std::string& name, Rect& window);
 			void EndWindow();
@@ -2,9 +2,20 @@
 #include "film.h"
 #include "txbase/math/sample.h"
 #include "txbase/image/filter.h"
+#include "txbase/sse/kernels.h"
 
 namespace TX
 {
+	namespace {
+		template<typename T>
+		T *NewBuffer(int size){
+			T *buffer = AllocAligned<T>(uint32_t(size), 64, MemoryTag::Film);
+			if (!buffer && size) throw std::bad_alloc();
+			std::uninitialized_fill_n(buffer, size, T());
+			return buffer;
+		}
+	}
+
 	void Film::Commit(float x, float y, const Color& color){
 		using namespace Math;
 #ifndef _DEBUG
@@ -32,9 +43,9 @@ namespace TX
 			width_ = width;
 			height_ = height;
 			size_ = width_ * height_;
-			pixels_.reset(new Color[width * height]);
-			unscaled_pixels_.reset(new Color[width * height]);
-			weights_.reset(new float[width * height]);
+			pixels_.reset(NewBuffer<Color>(size_));
+			unscaled_pixels_.reset(NewBuffer<Color>(size_));
+			weights_.reset(NewBuffer<float>(size_));
 		}
 	}
 
@@ -66,8 +77,7 @@ namespace TX
 	}
 
 	void Film::ScalePixels(){
-		for (int i = 0; i < size_; i++)
-			pixels_[i] = unscaled_pixels_[i] / weights_[i];
+		Kernels().ScaleColors(pixels_.get(), unscaled_pixels_.get(), weights_.get(), size_);
 	}
 
 	const Color *Film::Pixels() const {
@@ -2,6 +2,7 @@
 #include "txbase/fwddecl.h"
 #include <memory>
 #include "txbase/math/color.h"
+#include "txbase/sys/memory.h"
 
 namespace TX{
 	enum class FilterType{
@@ -37,9 +38,10 @@ namespace TX{
 
 	private:
 		int width_, height_, size_;
-		std::unique_ptr<Color[]> pixels_;	// or vector<Color> if Resize() is constantly called
-		std::unique_ptr<Color[]> unscaled_pixels_;	// or vector<Color> if Resize() is constantly called
+		// large films are mapped with huge pages, see AllocAligned()
+		std::unique_ptr<Color[], AlignedDeleter> pixels_;
+		std::unique_ptr<Color[], AlignedDeleter> unscaled_pixels_;
 		std::shared_ptr<Filter> filter_;
-		std::unique_ptr<float[]> weights_;
+		std::unique_ptr<float[], AlignedDeleter> weights_;
 	};
 }
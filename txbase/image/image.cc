@@ -1,5 +1,6 @@
 #include "txbase/stdafx.h"
 #include "txbase/image/image.h"
+#include "txbase/sse/kernels.h"
 #include <stdexcept>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -84,14 +85,20 @@ namespace TX {
 			}
 		}
 		else {
+			// rgba rows are converted in place, rgb ones go through a row of rgba
+			std::vector<unsigned char> row(channel == Color::Channel::RGB ? width * 4 : 0);
+			const KernelTable& kernels = Kernels();
 			for (int y = 0; y < height; y++){
 				buffer_i = ((flip_y ? height - y - 1 : y) * width) * pixel_size;
-				for (int x = 0, data_i = y * width; x < width; x++, data_i++){
-					buffer[buffer_i++] = Math::Clamp(Math::Round(data[data_i].r * 255), 0, 255);
-					buffer[buffer_i++] = Math::Clamp(Math::Round(data[data_i].g * 255), 0, 255);
-					buffer[buffer_i++] = Math::Clamp(Math::Round(data[data_i].b * 255), 0, 255);
-					if (channel == Color::Channel::RGBA)
-						buffer[buffer_i++] = Math::Clamp(Math::Round(data[data_i].a * 255), 0, 255);
+				if (channel == Color::Channel::RGBA){
+					kernels.QuantizeFloats(buffer + buffer_i, &data[y * width].r, width * 4);
+					continue;
+				}
+				kernels.QuantizeFloats(row.data(), &data[y * width].r, width * 4);
+				for (int x = 0; x < width; x++){
+					buffer[buffer_i++] = row[x * 4];
+					buffer[buffer_i++] = row[x * 4 + 1];
+					buffer[buffer_i++] = row[x * 4 + 2];
 				}
 			}
 		}
@@ -2,12 +2,13 @@
 
 #include "txbase/math/color.h"
 #include "txbase/math/vector.h"
+#include "txbase/sys/memtrack.h"
 #include <string>
 
 namespace TX{
 	class Image {
 	protected:
-		std::vector<Color> data;
+		TrackedVector<Color, MemoryTag::Image> data;
 		Vec2i dimension;
 	public:
 		enum Format {
@@ -0,0 +1,83 @@
+#include "txbase/stdafx.h"
+#include "txbase/math/affine.h"
+#include "txbase/sse/sse.h"
+#include "txbase/sse/soa.h"
+
+namespace TX{
+	const AffineTransform AffineTransform::IDENTITY = AffineTransform(
+		1.f, 0.f, 0.f, 0.f,
+		0.f, 1.f, 0.f, 0.f,
+		0.f, 0.f, 1.f, 0.f);
+
+	namespace {
+		inline __m128 Cross(const __m128& a, const __m128& b) {
+			const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+			const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+			const __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+			return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+		}
+	}
+
+	const AffineTransform& AffineTransform::operator *= (const AffineTransform& ot) {
+		const __m128 w = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+		const __m128 b0 = _mm_loadu_ps(&ot[0][0]);
+		const __m128 b1 = _mm_loadu_ps(&ot[1][0]);
+		const __m128 b2 = _mm_loadu_ps(&ot[2][0]);
+		for (int i = 0; i < 3; i++){
+			// the implicit last row of ot is (0, 0, 0, 1), which keeps the translation of this
+			const __m128 a = _mm_loadu_ps(&row[i][0]);
+			__m128 r = _mm_mul_ps(_mm_shuffle_ps(a, a, 0x00), b0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, 0x55), b1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xAA), b2));
+			r = _mm_add_ps(r, _mm_and_ps(a, w));
+			_mm_storeu_ps(&row[i][0], r);
+		}
+		return *this;
+	}
+
+	AffineTransform AffineTransform::Inverse() const {
+		AffineTransform result;
+		const __m128 xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+		const __m128 r0 = _mm_loadu_ps(&row[0][0]);
+		const __m128 r1 = _mm_loadu_ps(&row[1][0]);
+		const __m128 r2 = _mm_loadu_ps(&row[2][0]);
+		const __m128 a0 = _mm_and_ps(r0, xyz), a1 = _mm_and_ps(r1, xyz), a2 = _mm_and_ps(r2, xyz);
+		// the columns of the adjugate of the linear part A are the cross products of its rows
+		__m128 c0 = Cross(a1, a2), c1 = Cross(a2, a0), c2 = Cross(a0, a1);
+		__m128 det = _mm_mul_ps(a0, c0);
+		det = _mm_add_ss(_mm_add_ss(det, _mm_shuffle_ps(det, det, 0x55)), _mm_movehl_ps(det, det));
+		if (_mm_cvtss_f32(det) == 0.f)
+			return IDENTITY;
+		det = _mm_div_ss(_mm_set_ss(1.f), det);
+		det = _mm_shuffle_ps(det, det, 0x00);
+		c0 = _mm_mul_ps(c0, det);
+		c1 = _mm_mul_ps(c1, det);
+		c2 = _mm_mul_ps(c2, det);
+		// -A^-1 t, with t from the last lanes of the rows
+		__m128 t = _mm_mul_ps(c0, _mm_shuffle_ps(r0, r0, 0xFF));
+		t = _mm_add_ps(t, _mm_mul_ps(c1, _mm_shuffle_ps(r1, r1, 0xFF)));
+		t = _mm_add_ps(t, _mm_mul_ps(c2, _mm_shuffle_ps(r2, r2, 0xFF)));
+		t = _mm_sub_ps(_mm_setzero_ps(), t);
+		// columns to rows, the translation becomes the last column
+		_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+		_mm_storeu_ps(&result[0][0], c0);
+		_mm_storeu_ps(&result[1][0], c1);
+		_mm_storeu_ps(&result[2][0], c2);
+		return result;
+	}
+
+	void AffineTransform::TPoints(const AffineTransform& m, const Vec3 *in, Vec3 *out, size_t count){
+		typedef SSE::NativePacket<float> P;
+		SSE::ForEachPacket<P>(in, out, count, [&m](const Vec<3, P>& p){ return TPoint(m, p); });
+	}
+
+	void AffineTransform::TVecs(const AffineTransform& m, const Vec3 *in, Vec3 *out, size_t count){
+		typedef SSE::NativePacket<float> P;
+		SSE::ForEachPacket<P>(in, out, count, [&m](const Vec<3, P>& v){ return TVec(m, v); });
+	}
+
+	void AffineTransform::TNormals(const AffineTransform& m_inv, const Vec3 *in, Vec3 *out, size_t count){
+		typedef SSE::NativePacket<float> P;
+		SSE::ForEachPacket<P>(in, out, count, [&m_inv](const Vec<3, P>& n){ return TNormal(m_inv, n); });
+	}
+}
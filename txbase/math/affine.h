@@ -0,0 +1,161 @@
+#pragma once
+
+#include <iostream>
+#include "txbase/math/base.h"
+#include "txbase/math/vector.h"
+#include "txbase/math/matrix.h"
+
+namespace TX{
+	/// <summary>
+	/// Affine transformation stored as the top 3 rows of a row-major Matrix4x4, the last row being (0, 0, 0, 1).
+	/// 48 bytes instead of 64, composed and inverted with SSE.
+	/// </summary>
+	class AffineTransform {
+	public:
+		static const AffineTransform IDENTITY;
+	private:
+		Vec4 row[3];
+	public:
+		AffineTransform(){
+			row[0] = Vec4::X;
+			row[1] = Vec4::Y;
+			row[2] = Vec4::Z;
+		}
+		AffineTransform(const Vec4& r0, const Vec4& r1, const Vec4& r2){
+			row[0] = r0;
+			row[1] = r1;
+			row[2] = r2;
+		}
+		AffineTransform(const AffineTransform& ot) : AffineTransform(ot[0], ot[1], ot[2]){}
+		AffineTransform(const Matrix3x3& linear, const Vec3& translation = Vec3::ZERO) :
+			AffineTransform(
+				Vec4(linear[0], translation.x),
+				Vec4(linear[1], translation.y),
+				Vec4(linear[2], translation.z)){}
+		/// <summary>
+		/// Drops the last row of m, which should be (0, 0, 0, 1).
+		/// </summary>
+		explicit AffineTransform(const Matrix4x4& m) : AffineTransform(m[0], m[1], m[2]){}
+		AffineTransform(
+			float m00, float m01, float m02, float m03,
+			float m10, float m11, float m12, float m13,
+			float m20, float m21, float m22, float m23)
+			: AffineTransform(
+			Vec4(m00, m01, m02, m03),
+			Vec4(m10, m11, m12, m13),
+			Vec4(m20, m21, m22, m23)){}
+		~AffineTransform(){}
+
+		inline AffineTransform& operator = (const AffineTransform& ot){
+			row[0] = ot[0];
+			row[1] = ot[1];
+			row[2] = ot[2];
+			return *this;
+		}
+		inline bool operator == (const AffineTransform& ot) const {
+			return row[0] == ot[0] && row[1] == ot[1] && row[2] == ot[2];
+		}
+		inline bool operator != (const AffineTransform& ot) const { return !(*this == ot); }
+
+		inline AffineTransform operator * (const AffineTransform& ot) const {
+			AffineTransform result(*this);
+			return result *= ot;
+		}
+		/// <summary>
+		/// Composition, this applied after ot. The same as the product of the 4x4 matrices.
+		/// </summary>
+		const AffineTransform& operator *= (const AffineTransform& ot);
+
+		inline const Vec4& operator[](int rowi) const { return row[rowi]; }
+		inline Vec4& operator[](int rowi){ return row[rowi]; }
+		inline operator float*(){ return &row[0][0]; }
+		inline operator const float*() const { return &row[0][0]; }
+
+		inline Matrix3x3 Linear() const { return Matrix3x3(Vec3(row[0]), Vec3(row[1]), Vec3(row[2])); }
+		inline Vec3 Translation() const { return Vec3(row[0][3], row[1][3], row[2][3]); }
+		inline Matrix4x4 ToMatrix4x4() const { return Matrix4x4(row[0], row[1], row[2], Vec4::W); }
+
+		/// <summary>
+		/// The inverse of the linear part by Cramer's rule, and the translation moved through it.
+		/// The identity if the linear part is singular, as Matrix3x3::Inverse().
+		/// </summary>
+		AffineTransform Inverse() const;
+
+		/// <summary>
+		/// Transforms a point.
+		/// </summary>
+		static inline Vec3 TPoint(const AffineTransform& m, const Vec3& p){
+			return Vec3(
+				p.x * m[0][0] + p.y * m[0][1] + p.z * m[0][2] + m[0][3],
+				p.x * m[1][0] + p.y * m[1][1] + p.z * m[1][2] + m[1][3],
+				p.x * m[2][0] + p.y * m[2][1] + p.z * m[2][2] + m[2][3]);
+		}
+		/// <summary>
+		/// Transforms a vector.
+		/// </summary>
+		static inline Vec3 TVec(const AffineTransform& m, const Vec3& v){
+			return Vec3(
+				v.x * m[0][0] + v.y * m[0][1] + v.z * m[0][2],
+				v.x * m[1][0] + v.y * m[1][1] + v.z * m[1][2],
+				v.x * m[2][0] + v.y * m[2][1] + v.z * m[2][2]);
+		}
+		/// <summary>
+		/// Transforms a normal vector with an already inverted transform, the result is not normalized.
+		/// </summary>
+		static inline Vec3 TNormal(const AffineTransform& m_inv, const Vec3& n){
+			return Vec3(
+				n.x * m_inv[0][0] + n.y * m_inv[1][0] + n.z * m_inv[2][0],
+				n.x * m_inv[0][1] + n.y * m_inv[1][1] + n.z * m_inv[2][1],
+				n.x * m_inv[0][2] + n.y * m_inv[1][2] + n.z * m_inv[2][2]);
+		}
+
+		/// <summary>
+		/// TPoint(), TVec() and TNormal() on packets of vectors, e.g. Vec3V4F.
+		/// </summary>
+		template<typename P>
+		static inline Vec<3, P> TPoint(const AffineTransform& m, const Vec<3, P>& p){
+			return Vec<3, P>(
+				p.x * P(m[0][0]) + p.y * P(m[0][1]) + p.z * P(m[0][2]) + P(m[0][3]),
+				p.x * P(m[1][0]) + p.y * P(m[1][1]) + p.z * P(m[1][2]) + P(m[1][3]),
+				p.x * P(m[2][0]) + p.y * P(m[2][1]) + p.z * P(m[2][2]) + P(m[2][3]));
+		}
+		template<typename P>
+		static inline Vec<3, P> TVec(const AffineTransform& m, const Vec<3, P>& v){
+			return Vec<3, P>(
+				v.x * P(m[0][0]) + v.y * P(m[0][1]) + v.z * P(m[0][2]),
+				v.x * P(m[1][0]) + v.y * P(m[1][1]) + v.z * P(m[1][2]),
+				v.x * P(m[2][0]) + v.y * P(m[2][1]) + v.z * P(m[2][2]));
+		}
+		template<typename P>
+		static inline Vec<3, P> TNormal(const AffineTransform& m_inv, const Vec<3, P>& n){
+			return Vec<3, P>(
+				n.x * P(m_inv[0][0]) + n.y * P(m_inv[1][0]) + n.z * P(m_inv[2][0]),
+				n.x * P(m_inv[0][1]) + n.y * P(m_inv[1][1]) + n.z * P(m_inv[2][1]),
+				n.x * P(m_inv[0][2]) + n.y * P(m_inv[1][2]) + n.z * P(m_inv[2][2]));
+		}
+
+		/// <summary>
+		/// TPoint(), TVec() and TNormal() over arrays, out[i] = T(m, in[i]). out may be the same array as in.
+		/// </summary>
+		static void TPoints(const AffineTransform& m, const Vec3 *in, Vec3 *out, size_t count);
+		static void TVecs(const AffineTransform& m, const Vec3 *in, Vec3 *out, size_t count);
+		static void TNormals(const AffineTransform& m_inv, const Vec3 *in, Vec3 *out, size_t count);
+
+		static inline AffineTransform Translate(const Vec3& v){ return AffineTransform(Matrix3x3::IDENTITY, v); }
+		static inline AffineTransform Scale(const Vec3& s){
+			return AffineTransform(
+				s.x, 0.f, 0.f, 0.f,
+				0.f, s.y, 0.f, 0.f,
+				0.f, 0.f, s.z, 0.f);
+		}
+	};
+
+	inline std::ostream& operator << (std::ostream& os, const AffineTransform& m){
+		for (int i = 0; i < 3; i++){
+			for (int j = 0; j < 4; j++)
+				os << m[i][j] << "\t";
+			os << std::endl;
+		}
+		return os;
+	}
+}
@@ -1,8 +1,11 @@
 #include "txbase/stdafx.h"
 #include "txbase/math/matrix.h"
+#include "txbase/math/affine.h"
 #include "txbase/math/vector.h"
 #include "txbase/math/ray.h"
 #include "txbase/sse/sse.h"
+#include "txbase/sse/soa.h"
+#include "txbase/sse/kernels.h"
 
 namespace TX{
 	const Matrix3x3 Matrix3x3::IDENTITY = Matrix3x3(
@@ -18,6 +21,23 @@ namespace TX{
 		0.f, 0.f, 1.f, 0.f,
 		0.f, 0.f, 0.f, 1.f);
 
+	const Matrix4x4& Matrix4x4::operator *= (const Matrix4x4& ot) {
+		const __m128 b0 = _mm_loadu_ps(&ot[0][0]);
+		const __m128 b1 = _mm_loadu_ps(&ot[1][0]);
+		const __m128 b2 = _mm_loadu_ps(&ot[2][0]);
+		const __m128 b3 = _mm_loadu_ps(&ot[3][0]);
+		for (int i = 0; i < 4; i++){
+			// row i only depends on row i of this, so the product can go in place, also for m *= m
+			const __m128 a = _mm_loadu_ps(&row[i][0]);
+			__m128 r = _mm_mul_ps(_mm_shuffle_ps(a, a, 0x00), b0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, 0x55), b1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xAA), b2));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xFF), b3));
+			_mm_storeu_ps(&row[i][0], r);
+		}
+		return *this;
+	}
+
 	Matrix4x4 Matrix4x4::Inverse() const {
 		Matrix4x4 result;
 		const float *src = (const float *)*row;
@@ -83,8 +103,8 @@ namespace TX{
 		det = _mm_mul_ps(row0, minor0);
 		det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
 		det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
-		tmp1 = _mm_rcp_ss(det);
-		det = _mm_sub_ss(_mm_add_ss(tmp1, tmp1), _mm_mul_ss(det, _mm_mul_ss(tmp1, tmp1)));
+		// one exact division instead of rcp and a Newton step, it costs little next to the rest
+		det = _mm_div_ss(_mm_set_ss(1.f), det);
 		det = _mm_shuffle_ps(det, det, 0x00);
 		minor0 = _mm_mul_ps(det, minor0);
 		_mm_storel_pi((__m64*)(dst), minor0);
@@ -101,6 +121,26 @@ namespace TX{
 		return result;
 	}
 
+	Matrix4x4 Matrix4x4::InverseAffine() const {
+		return AffineTransform(*this).Inverse().ToMatrix4x4();
+	}
+
+	void Matrix4x4::TPoints(const Matrix4x4& m, const Vec3 *in, Vec3 *out, size_t count){
+		const size_t CHUNK = size_t(1) << 30;
+		for (size_t i = 0; i < count; i += CHUNK)
+			Kernels().TransformPoints(out + i, m, in + i, int(std::min(count - i, CHUNK)));
+	}
+
+	void Matrix4x4::TVecs(const Matrix4x4& m, const Vec3 *in, Vec3 *out, size_t count){
+		typedef SSE::NativePacket<float> P;
+		SSE::ForEachPacket<P>(in, out, count, [&m](const Vec<3, P>& v){ return TVec(m, v); });
+	}
+
+	void Matrix4x4::TNormals(const Matrix4x4& m_inv, const Vec3 *in, Vec3 *out, size_t count){
+		typedef SSE::NativePacket<float> P;
+		SSE::ForEachPacket<P>(in, out, count, [&m_inv](const Vec<3, P>& n){ return TNormal(m_inv, n); });
+	}
+
 	Matrix4x4 Matrix4x4::Translate(const Vec3& v){
 		return Translate(v.x, v.y, v.z);
 	}
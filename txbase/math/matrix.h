@@ -102,9 +102,19 @@ namespace TX{
 				row[0][2], row[1][2], row[2][2]);
 		}
 
+		/// <summary>
+		/// Inverse by Cramer's rule, the identity for a singular matrix.
+		/// </summary>
 		inline Matrix3x3 Inverse() const {
-			//TODO
-			return Matrix3x3();
+			// the columns of the adjugate are the cross products of the rows
+			const Vec3 c0 = Math::Cross(row[1], row[2]);
+			const Vec3 c1 = Math::Cross(row[2], row[0]);
+			const Vec3 c2 = Math::Cross(row[0], row[1]);
+			const float det = Math::Dot(row[0], c0);
+			if (det == 0.f)
+				return IDENTITY;
+			const float inv_det = 1.f / det;
+			return Matrix3x3(c0 * inv_det, c1 * inv_det, c2 * inv_det).Transpose();
 		}
 	};
 
@@ -182,15 +192,8 @@ namespace TX{
 				row[3] - ot[3]);
 		}
 		inline Matrix4x4 operator * (const Matrix4x4& ot) const {
-			Matrix4x4 result;
-			for (int i = 0; i < 4; i++)
-				for (int j = 0; j < 4; j++)
-					result[i][j] =
-					row[i][0] * ot[0][j] +
-					row[i][1] * ot[1][j] +
-					row[i][2] * ot[2][j] +
-					row[i][3] * ot[3][j];
-			return result;
+			Matrix4x4 result(*this);
+			return result *= ot;
 		}
 		inline const Matrix4x4& operator += (const Matrix4x4& ot){
 			row[0] += ot[0];
@@ -206,19 +209,10 @@ namespace TX{
 			row[3] -= ot[3];
 			return *this;
 		}
-		inline const Matrix4x4& operator *= (const Matrix4x4& ot) {
-			Vec4 temp;
-			for (int i = 0; i < 4; i++){
-				for (int j = 0; j < 4; j++)
-					temp[j] =
-					row[i][0] * ot[0][j] +
-					row[i][1] * ot[1][j] +
-					row[i][2] * ot[2][j] +
-					row[i][3] * ot[3][j];
-				row[i] = temp;
-			}
-			return *this;
-		}
+		/// <summary>
+		/// Each row of the product as a sum of the rows of ot, four lanes at a time.
+		/// </summary>
+		const Matrix4x4& operator *= (const Matrix4x4& ot);
 
 		inline const Vec4& operator[](int rowi) const { return row[rowi]; }
 		inline Vec4& operator[](int rowi){ return row[rowi]; }
@@ -234,6 +228,11 @@ namespace TX{
 		}
 
 		Matrix4x4 Inverse() const;
+		/// <summary>
+		/// Inverse of an affine matrix, one whose last row is (0, 0, 0, 1): the inverse of the 3x3 part
+		/// by Cramer's rule, and the translation moved through it. Cheaper than Inverse().
+		/// </summary>
+		Matrix4x4 InverseAffine() const;
 
 		/// <summary>
 		/// Transforms a point.
@@ -266,6 +265,38 @@ namespace TX{
 				n.x * m_inv[0][2] + n.y * m_inv[1][2] + n.z * m_inv[2][2]);
 		}
 
+		/// <summary>
+		/// TPoint(), TVec() and TNormal() on packets of vectors, e.g. Vec3V4F.
+		/// </summary>
+		template<typename P>
+		static inline Vec<3, P> TPoint(const Matrix4x4& m, const Vec<3, P>& p){
+			return Vec<3, P>(
+				p.x * P(m[0][0]) + p.y * P(m[0][1]) + p.z * P(m[0][2]) + P(m[0][3]),
+				p.x * P(m[1][0]) + p.y * P(m[1][1]) + p.z * P(m[1][2]) + P(m[1][3]),
+				p.x * P(m[2][0]) + p.y * P(m[2][1]) + p.z * P(m[2][2]) + P(m[2][3]));
+		}
+		template<typename P>
+		static inline Vec<3, P> TVec(const Matrix4x4& m, const Vec<3, P>& v){
+			return Vec<3, P>(
+				v.x * P(m[0][0]) + v.y * P(m[0][1]) + v.z * P(m[0][2]),
+				v.x * P(m[1][0]) + v.y * P(m[1][1]) + v.z * P(m[1][2]),
+				v.x * P(m[2][0]) + v.y * P(m[2][1]) + v.z * P(m[2][2]));
+		}
+		template<typename P>
+		static inline Vec<3, P> TNormal(const Matrix4x4& m_inv, const Vec<3, P>& n){
+			return Vec<3, P>(
+				n.x * P(m_inv[0][0]) + n.y * P(m_inv[1][0]) + n.z * P(m_inv[2][0]),
+				n.x * P(m_inv[0][1]) + n.y * P(m_inv[1][1]) + n.z * P(m_inv[2][1]),
+				n.x * P(m_inv[0][2]) + n.y * P(m_inv[1][2]) + n.z * P(m_inv[2][2]));
+		}
+
+		/// <summary>
+		/// TPoint(), TVec() and TNormal() over arrays, out[i] = T(m, in[i]). out may be the same array as in.
+		/// </summary>
+		static void TPoints(const Matrix4x4& m, const Vec3 *in, Vec3 *out, size_t count);
+		static void TVecs(const Matrix4x4& m, const Vec3 *in, Vec3 *out, size_t count);
+		static void TNormals(const Matrix4x4& m_inv, const Vec3 *in, Vec3 *out, size_t count);
+
 		static Matrix4x4 Translate(const Vec3& v);
 		static Matrix4x4 Translate(float x, float y, float z);
 
@@ -38,13 +38,13 @@ namespace TX{
 		if (dirty_) {
 			// apply scale, rotation, translation in this order (by the right associativity)
 			// so that translation isn't affected by scale or rotation
-			local_world_ = Matrix4x4::Translate(data_.pos)
-				* data_.rot.RotationMatrix4x4()
-				* Matrix4x4::Scale(data_.scale);
+			local_world_ = AffineTransform::Translate(data_.pos)
+				* AffineTransform(Matrix3x3(data_.rot.RotationMatrix4x4()))
+				* AffineTransform::Scale(data_.scale);
 			world_local_ = // local_world_.Inverse();
-				Matrix4x4::Scale(Vec3::ONE / data_.scale)
-				* data_.rot.Conjugate().RotationMatrix4x4()
-				* Matrix4x4::Translate(-data_.pos);
+				AffineTransform::Scale(Vec3::ONE / data_.scale)
+				* AffineTransform(Matrix3x3(data_.rot.Conjugate().RotationMatrix4x4()))
+				* AffineTransform::Translate(-data_.pos);
 			dirty_ = false;
 		}
 	}
@@ -1,6 +1,7 @@
 #pragma once
 #include "txbase/math/quaternion.h"
 #include "txbase/math/matrix.h"
+#include "txbase/math/affine.h"
 #include "txbase/math/ray.h"
 
 namespace TX{
@@ -21,14 +22,14 @@ namespace TX{
 		};
 		TransformInfo data_;
 		mutable bool dirty_;
-		mutable Matrix4x4 local_world_;
-		mutable Matrix4x4 world_local_;
+		mutable AffineTransform local_world_;
+		mutable AffineTransform world_local_;
 	public:
 		Transform() :
 			data_(),
 			dirty_(false),
-			local_world_(Matrix4x4::IDENTITY),
-			world_local_(Matrix4x4::IDENTITY)
+			local_world_(AffineTransform::IDENTITY),
+			world_local_(AffineTransform::IDENTITY)
 			{}
 		Transform(const Transform& ot) :
 			data_(ot.data_),
@@ -41,13 +42,22 @@ namespace TX{
 			world_local_ = tr.world_local_;
 			return *this;
 		}
-		inline Vec3 Right() const { return Matrix4x4::TVec(local_world_, Vec3::X); }
-		inline Vec3 Up() const { return Matrix4x4::TVec(local_world_, Vec3::Y); }
-		inline Vec3 Forward() const { return Matrix4x4::TVec(local_world_, -Vec3::Z); }
+		inline Vec3 Right() const { return AffineTransform::TVec(local_world_, Vec3::X); }
+		inline Vec3 Up() const { return AffineTransform::TVec(local_world_, Vec3::Y); }
+		inline Vec3 Forward() const { return AffineTransform::TVec(local_world_, -Vec3::Z); }
 		/// <summary> Make sure the world matrix is updated before calling this. </summary>
-		inline const Matrix4x4& WorldToLocalMatrix() const { return world_local_; }
+		inline const AffineTransform& WorldToLocal() const { return world_local_; }
 		/// <summary> Make sure the world matrix is updated before calling this. </summary>
-		inline const Matrix4x4& LocalToWorldMatrix() const { return local_world_; }
+		inline const AffineTransform& LocalToWorld() const { return local_world_; }
+		/// <summary> WorldToLocal() as a 4x4 matrix. </summary>
+		inline Matrix4x4 WorldToLocalMatrix() const { return world_local_.ToMatrix4x4(); }
+		/// <summary> LocalToWorld() as a 4x4 matrix. </summary>
+		inline Matrix4x4 LocalToWorldMatrix() const { return local_world_.ToMatrix4x4(); }
+		/// <summary>
+		/// The inverse transpose of the linear part of LocalToWorld(), which transforms normals to world space.
+		/// Make sure the world matrix is updated before calling this.
+		/// </summary>
+		inline Matrix3x3 NormalMatrix() const { return world_local_.Linear().Transpose(); }
 
 		inline const Vec3& GetPosition() const { return data_.pos; }
 		inline const Quaternion& GetRotation() const { return data_.rot; }
@@ -68,16 +78,16 @@ namespace TX{
 		/// Make sure the world matrix is updated before calling this.
 		/// </summary>
 		inline void ToWorld(Ray& ray) const {
-			ray.origin = Matrix4x4::TPoint(local_world_, ray.origin);
-			ray.dir = Math::Normalize(Matrix4x4::TVec(local_world_, ray.dir));
+			ray.origin = AffineTransform::TPoint(local_world_, ray.origin);
+			ray.dir = Math::Normalize(AffineTransform::TVec(local_world_, ray.dir));
 		}
 		/// <summary>
 		/// Transforms a global ray to local space WITHOUT normalizing it (so that t_max is valid).
 		/// Make sure the world matrix is updated before calling this.
 		/// </summary>
 		inline void ToLocal(Ray& ray) const {
-			ray.origin = Matrix4x4::TPoint(world_local_, ray.origin);
-			ray.dir = Matrix4x4::TVec(world_local_, ray.dir);
+			ray.origin = AffineTransform::TPoint(world_local_, ray.origin);
+			ray.dir = AffineTransform::TVec(world_local_, ray.dir);
 		}
 		/// <summary>
 		/// Update the world matrix.
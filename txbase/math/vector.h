@@ -59,7 +59,7 @@ namespace TX
 		static const Vec Y;
 		static const Vec UNIT[2];
 	public:
-		inline Vec() : x(Math::ZERO), y(Math::ZERO){}
+		inline Vec() : x(), y(){}
 		inline Vec(const Vec& ot) : x(ot.x), y(ot.y){}
 		explicit inline Vec(T val) : x(val), y(val){}
 		inline Vec(const T& x, const T& y) : x(x), y(y){}
@@ -164,7 +164,7 @@ namespace TX
 		static const Vec RIGHT;
 		static const Vec UP;
 	public:
-		inline Vec() : x(Math::ZERO), y(Math::ZERO), z(Math::ZERO){}
+		inline Vec() : x(), y(), z(){}
 		explicit inline Vec(const T& val) : x(val), y(val), z(val){}
 		inline Vec(const T& x, const T& y, const T& z) : x(x), y(y), z(z){}
 		inline Vec(const Vec& ot) : x(ot.x), y(ot.y), z(ot.z){}
@@ -296,7 +296,7 @@ namespace TX
 		static const Vec PI;
 		static const Vec PI_RCP;
 	public:
-		inline Vec() : x(Math::ZERO), y(Math::ZERO), z(Math::ZERO), w(Math::ZERO){}
+		inline Vec() : x(), y(), z(), w(){}
 		explicit inline Vec(const T& val) : x(val), y(val), z(val), w(val){}
 		inline Vec(const T& x, const T& y, const T& z, const T& w) : x(x), y(y), z(z), w(w){}
 		inline Vec(const Vec<2, T>& a, const Vec<2, T>& b) : x(a.x), y(a.y), z(b.x), w(b.y){}
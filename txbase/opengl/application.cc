@@ -5,7 +5,7 @@
 
 namespace TX {
 	namespace UI {
-		Application::Application() {
+		Application::Application() : frameArena(32768, MemoryTag::GUI) {
 			config.title = "Application";
 		}
 		void Application::Run() {
@@ -137,6 +137,7 @@ namespace TX {
 			deltaTime = now - frameStart;
 			fps = Math::Lerp(0.95f, 1.f / deltaTime, fps);
 			frameStart = now;
+			frameArena.FreeAll();
 			//glfwSetWindowTitle(window, (config.title + '[' + std::to_string(int(GetFrameRate())) + ']').c_str());
 		}
 
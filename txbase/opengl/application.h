@@ -2,6 +2,7 @@
 
 #include "txbase/fwddecl.h"
 #include "txbase/opengl/input.h"
+#include "txbase/sys/memory.h"
 
 namespace TX {
 	namespace UI {
@@ -53,6 +54,10 @@ namespace TX {
 // 			void				Refresh();
 			bool				IsWindowVisible();
 			void				Exit();
+			/// <summary>
+			/// Scratch memory of the current frame, freed all at once when the next frame starts.
+			/// </summary>
+			MemoryArena&		GetFrameArena() { return frameArena; }
 		private:
 			static Application * This(GLFWwindow *window);
 			static void GLFWKey(GLFWwindow *window, int key, int scancode, int action, int mods);
@@ -78,6 +83,7 @@ namespace TX {
 			float frameEnd;
 			float deltaTime;
 			float fps;
+			MemoryArena frameArena;
 		};
 
 		class InputHandledApplication : public Application {
@@ -55,14 +55,17 @@ namespace TX
 		class Buffer : public Object {
 		public:
 			Buffer(){ glGenBuffers(1, &id); }
-			Buffer(Buffer&& that) : Object(std::move(that)){}
+			Buffer(Buffer&& that) : Object(std::move(that)), memory(std::move(that.memory)){}
 			~Buffer(){ if(id) glDeleteBuffers(1, &id); }
 			inline void Data(GLsizeiptr size, const void *data){
 				Bind();
 				glBufferData(Target, size, data, GL_STATIC_DRAW);
+				memory.Set(size_t(size));
 			}
 			inline void Bind() const { glBindBuffer(Target, id); }
 			inline static void Unbind() { glBindBuffer(Target, 0); }
+		private:
+			TrackedBytes<MemoryTag::GLStaging> memory;	// size of the data uploaded last
 		};
 		typedef Buffer<GL_ARRAY_BUFFER> VertexBuffer;
 		typedef Buffer<GL_ELEMENT_ARRAY_BUFFER> IndexBuffer;
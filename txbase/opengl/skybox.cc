@@ -73,7 +73,7 @@ namespace TX {
 			Use();
 
 			// Remove translation so that camera is always centered at skybox
-			Matrix4x4 V = Matrix4x4(Matrix3x3(camera.transform.WorldToLocalMatrix()));
+			Matrix4x4 V = Matrix4x4(camera.transform.WorldToLocal().Linear());
 			SetUniform("iMVP", camera.CameraToViewport() * V);
 
 			p->cubemap.Bind();
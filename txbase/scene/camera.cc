@@ -1,6 +1,7 @@
 #include "txbase/stdafx.h"
 #include "camera.h"
 #include "txbase/math/sample.h"
+#include "txbase/sse/soa.h"
 
 namespace TX{
 	Camera::Camera(int res_x, int res_y, float fov, float near, float far, bool ortho) :
@@ -18,14 +19,32 @@ namespace TX{
 		transform.ToWorld(*out);
 	}
 
+	void Camera::GenerateRays(Ray *out, const float *screenX, const float *screenY, int count) const {
+		typedef SSE::NativePacket<float> P;
+		const int W = SSE::PacketTraits<P>::WIDTH;
+		const AffineTransform& local_world = transform.LocalToWorld();
+		const Vec3 origin = local_world.Translation();
+		for (int i = 0; i < count; i += W){
+			const int n = std::min(W, count - i);
+			const auto lanes = SSE::FirstLanes<P>(n);
+			const Vec<3, P> pix(SSE::MaskedLoad<P>(lanes, screenX + i), SSE::MaskedLoad<P>(lanes, screenY + i), P(-1.f));
+			// the same steps as GenerateRay() and Transform::ToWorld()
+			const Vec<3, P> dir = Math::Normalize(AffineTransform::TVec(local_world, Matrix4x4::TPoint(screen_cam_, pix)));
+			Vec3 dirs[W];
+			SSE::StoreVec3<P>(dir, dirs, n);
+			for (int k = 0; k < n; k++)
+				out[i + k].Reset(origin, dirs[k]);
+		}
+	}
+
 
 	Vec3 Camera::ScreenToWorldPoint(const Vec3& pix) const{
-		return Matrix4x4::TPoint(transform.LocalToWorldMatrix(),
+		return AffineTransform::TPoint(transform.LocalToWorld(),
 			Matrix4x4::TPoint(screen_cam_, pix));
 	}
 	Vec3 Camera::WorldToScreenPoint(const Vec3& point) const {
 		return Matrix4x4::TPoint(cam_screen_,
-			Matrix4x4::TPoint(transform.WorldToLocalMatrix(), point));
+			AffineTransform::TPoint(transform.WorldToLocal(), point));
 	}
 
 	Camera& Camera::Resize(int w, int h) {
@@ -9,6 +9,10 @@ namespace TX
 		Camera(int width=800, int height=600, float fov = 90.f, float near = 0.1f, float far = 1000.f, bool is_ortho = false);
 
 		void GenerateRay(Ray *out, float screenX, float screenY) const;
+		/// <summary>
+		/// GenerateRay() for the pixels (screenX[i], screenY[i]), i in [0, count), a packet of rays at a time.
+		/// </summary>
+		void GenerateRays(Ray *out, const float *screenX, const float *screenY, int count) const;
 
 		inline int Width() const { return width_; }
 		inline int Height() const { return height_; }
@@ -30,6 +30,18 @@ namespace TX {
 			GL::SetUniform(mvp[MVP_V_INV], vInv);
 			GL::SetUniform(mvp[MVP_M_3X3_INV_TR], m3x3InvTr);
 		}
+		/// <summary>
+		/// SetMVP() with the model matrix and its normal matrix taken from the transform of the model.
+		/// Make sure the world matrix of model is updated before calling this.
+		/// </summary>
+		inline void SetMVP(
+			const Transform& model,
+			const Matrix4x4& v,
+			const Matrix4x4& p,
+			const Matrix4x4& vInv
+			) const {
+			SetMVP(model.LocalToWorldMatrix(), v, p, vInv, model.NormalMatrix());
+		}
 	private:
 		// override this in the subclass
 		virtual void CompileProgram(){}
@@ -3,6 +3,8 @@
 #include "mesh.h"
 #include "obj.h"
 #include "txbase/math/sample.h"
+#include "txbase/sse/kernels.h"
+#include "txbase/sse/soa.h"
 
 namespace TX {
 	void Mesh::Clear() {
@@ -15,16 +17,16 @@ namespace TX {
 
 	void Mesh::ApplyTransform(const Transform& transform) {
 		transform.UpdateMatrix();
-		const Matrix4x4& world2local = transform.WorldToLocalMatrix();
-		const Matrix4x4& local2world = transform.LocalToWorldMatrix();
-		if (local2world == Matrix4x4::IDENTITY)
+		const AffineTransform& world2local = transform.WorldToLocal();
+		const AffineTransform& local2world = transform.LocalToWorld();
+		if (local2world == AffineTransform::IDENTITY)
 			return;
-		for (auto vert = vertices.begin(); vert < vertices.end(); vert++) {
-			*vert = Matrix4x4::TPoint(local2world, *vert);
-		}
-		for (auto norm = normals.begin(); norm < normals.end(); norm++) {
-			*norm = Math::Normalize(Matrix4x4::TNormal(world2local, *norm));
-		}
+		AffineTransform::TPoints(local2world, vertices.data(), vertices.data(), vertices.size());
+		typedef SSE::NativePacket<float> P;
+		const AffineTransform& m = world2local;
+		SSE::ForEachPacket<P>(normals.data(), normals.data(), normals.size(), [&m](const Vec<3, P>& n){
+			return Math::Normalize(AffineTransform::TNormal(m, n));
+		});
 		bbox_dirty_ = true;
 	}
 
@@ -46,7 +48,7 @@ namespace TX {
 			return false;
 		const Vec3 Q = Math::Cross(T, e1);
 		const float v = Math::Dot(ray.dir, Q) * invDet;
-		if (!Math::InBounds(v, 0.f, 1.f))
+		if (!Math::InBounds(v, 0.f, 1.f - u))
 			return false;
 
 		const float t = Math::Dot(e2, Q) * invDet;
@@ -57,6 +59,9 @@ namespace TX {
 		ray.t_max = t;
 		return true;
 	}
+	int Mesh::Intersect(const uint32_t *triIds, int count, const Ray& ray) const {
+		return Kernels().IntersectTriangles(vertices.data(), indices.data(), triIds, count, ray);
+	}
 	bool Mesh::Occlude(uint32_t triId, const Ray& ray) const {
 		const uint32_t* idx = GetIndicesOfTriangle(triId);
 		const Vec3& v0 = vertices[*idx];
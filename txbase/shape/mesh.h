@@ -6,14 +6,15 @@
 #include "txbase/math/ray.h"
 #include "txbase/math/transform.h"
 #include "txbase/math/sample.h"
+#include "txbase/sys/memtrack.h"
 
 namespace TX {
 	class Mesh {
 	public:
-		std::vector<Vec3> vertices;
-		std::vector<Vec3> normals;
-		std::vector<uint32_t> indices;
-		std::vector<Vec2> uv;
+		TrackedVector<Vec3, MemoryTag::Mesh> vertices;
+		TrackedVector<Vec3, MemoryTag::Mesh> normals;
+		TrackedVector<uint32_t, MemoryTag::Mesh> indices;
+		TrackedVector<Vec2, MemoryTag::Mesh> uv;
 	private:
 		mutable BBox bbox_;
 		mutable bool bbox_dirty_ = true;
@@ -86,6 +87,10 @@ namespace TX {
 		float Area() const;
 		float Area(uint32_t triId) const;
 		bool Intersect(uint32_t triId, const Ray& ray) const;
+		/// <summary>
+		/// Intersects a batch of triangles, returns the index in triIds of the closest hit or -1.
+		/// </summary>
+		int Intersect(const uint32_t *triIds, int count, const Ray& ray) const;
 		bool Occlude(uint32_t triId, const Ray& ray) const;
 	};
 
@@ -88,7 +88,7 @@ namespace TX
 		inline V4Bool UnpackHigh(const V4Bool& a, const V4Bool& b) { return _mm_unpackhi_ps(a.m, b.m); }
 
 		template<size_t v0, size_t v1, size_t v2, size_t v3>
-		inline const V4Bool Shuffle(const V4Bool& a){ return _mm_shuffle_epi32(a, _MM_SHUFFLE(v3, v2, v1, v0)); }
+		inline const V4Bool Shuffle(const V4Bool& a){ return _mm_shuffle_epi32(_mm_castps_si128(a), _MM_SHUFFLE(v3, v2, v1, v0)); }
 		template<size_t a0, size_t a1, size_t b2, size_t b3>
 		inline const V4Bool Shuffle(const V4Bool& a, const V4Bool& b){ return _mm_shuffle_ps(a, b, _MM_SHUFFLE(b3, b2, a1, a0)); }
 
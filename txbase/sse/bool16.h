@@ -0,0 +1,61 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+#include "txbase/sse/bool8.h"
+
+#ifdef __AVX512F__
+namespace TX
+{
+	namespace SSE
+	{
+		/// <summary>
+		/// Sixteen lane mask of AVX-512, one bit per lane in a mask register.
+		/// </summary>
+		struct V16Bool {
+		public:
+			__mmask16 m;
+		public:
+			inline V16Bool() : m(0) {}
+			inline V16Bool(__mmask16 mask) : m(mask) {}
+			inline V16Bool(const V16Bool& ot) : m(ot.m) {}
+			inline V16Bool(const V8Bool& lo, const V8Bool& hi) : m(__mmask16(_mm256_movemask_ps(lo) | (_mm256_movemask_ps(hi) << 8))) {}
+			inline V16Bool(bool a) : m(a ? 0xFFFF : 0) {}
+
+			inline V16Bool& operator = (const V16Bool& ot){ m = ot.m; return *this; }
+
+			inline operator const __mmask16&(void) const { return m; }
+			inline operator       __mmask16&(void)       { return m; }
+
+			inline bool operator [] (const size_t i) const { return (m >> i) & 1; }
+
+			inline const V16Bool operator ! () const { return __mmask16(~m); }
+			inline const V16Bool operator & (const V16Bool& ot) const { return __mmask16(m & ot.m); }
+			inline const V16Bool operator | (const V16Bool& ot) const { return __mmask16(m | ot.m); }
+			inline const V16Bool operator ^ (const V16Bool& ot) const { return __mmask16(m ^ ot.m); }
+			inline const V16Bool operator &= (const V16Bool& ot) { return *this = *this & ot; }
+			inline const V16Bool operator |= (const V16Bool& ot) { return *this = *this | ot; }
+			inline const V16Bool operator ^= (const V16Bool& ot) { return *this = *this ^ ot; }
+			inline const V16Bool operator != (const V16Bool& ot) const { return *this ^ ot; }
+			inline const V16Bool operator == (const V16Bool& ot) const { return !(*this ^ ot); }
+		};
+
+		inline std::ostream& operator << (std::ostream& os, const V16Bool& v) {
+			os << "(" << v[0];
+			for (int i = 1; i < 16; i++)
+				os << ", " << v[i];
+			return os << ")";
+		}
+
+		inline bool All(const V16Bool& a) { return a.m == 0xFFFF; }
+		inline bool Any(const V16Bool& a) { return a.m != 0; }
+		inline bool None(const V16Bool& a) { return a.m == 0; }
+	}
+}
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+#include "txbase/sse/bool.h"
+
+#ifdef __AVX2__
+namespace TX
+{
+	namespace SSE
+	{
+		/// <summary>
+		/// Eight lane mask of AVX, the lanes are either all zeros or all ones.
+		/// </summary>
+		struct V8Bool {
+		public:
+			union{
+				__m256 m;
+				int32_t v[8];
+			};
+		public:
+			inline V8Bool() : m(_mm256_setzero_ps()) {}
+			inline V8Bool(__m256i mi) : m(_mm256_castsi256_ps(mi)) {}
+			inline V8Bool(__m256 mf) : m(mf) {}
+			inline V8Bool(const V8Bool& ot) : m(ot.m) {}
+			inline V8Bool(const V4Bool& lo, const V4Bool& hi) : m(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1)) {}
+			inline V8Bool(bool a) : m(_mm256_castsi256_ps(_mm256_set1_epi32(-int32_t(a)))) {}
+			inline V8Bool(bool a, bool b, bool c, bool d, bool e, bool f, bool g, bool h) :
+				m(_mm256_castsi256_ps(_mm256_setr_epi32(-int32_t(a), -int32_t(b), -int32_t(c), -int32_t(d),
+				-int32_t(e), -int32_t(f), -int32_t(g), -int32_t(h)))) {}
+
+			inline V8Bool& operator = (const V8Bool& ot){ m = ot.m; return *this; }
+
+			inline operator const __m256&(void) const { return m; }
+			inline operator       __m256&(void)       { return m; }
+
+			inline bool     operator [] (const size_t i) const { return (_mm256_movemask_ps(m) >> i) & 1; }
+			inline int32_t& operator [] (const size_t i)       { return v[i]; }
+
+			inline const V4Bool Low() const { return _mm256_castps256_ps128(m); }
+			inline const V4Bool High() const { return _mm256_extractf128_ps(m, 1); }
+
+			inline const V8Bool operator ! () const { return _mm256_xor_ps(*this, V8Bool(true)); }
+			inline const V8Bool operator & (const V8Bool& ot) const { return _mm256_and_ps(*this, ot); }
+			inline const V8Bool operator | (const V8Bool& ot) const { return _mm256_or_ps(*this, ot); }
+			inline const V8Bool operator ^ (const V8Bool& ot) const { return _mm256_xor_ps(*this, ot); }
+			inline const V8Bool operator &= (const V8Bool& ot) { return *this = *this & ot; }
+			inline const V8Bool operator |= (const V8Bool& ot) { return *this = *this | ot; }
+			inline const V8Bool operator ^= (const V8Bool& ot) { return *this = *this ^ ot; }
+			inline const V8Bool operator != (const V8Bool& ot) const { return _mm256_xor_ps(*this, ot); }
+			// compared as integers, set lanes are NaNs as floats
+			inline const V8Bool operator == (const V8Bool& ot) const { return _mm256_cmpeq_epi32(_mm256_castps_si256(m), _mm256_castps_si256(ot.m)); }
+		};
+
+		inline std::ostream& operator << (std::ostream& os, const V8Bool& v) {
+			os << "(" << v.v[0];
+			for (int i = 1; i < 8; i++)
+				os << ", " << v.v[i];
+			return os << ")";
+		}
+
+		/// <summary>
+		/// Interleave within each half, like the 128 bit versions applied to both halves.
+		/// </summary>
+		inline V8Bool UnpackLow(const V8Bool& a, const V8Bool& b) { return _mm256_unpacklo_ps(a.m, b.m); }
+		inline V8Bool UnpackHigh(const V8Bool& a, const V8Bool& b) { return _mm256_unpackhi_ps(a.m, b.m); }
+
+		/// <summary>
+		/// Shuffles each half with the same pattern.
+		/// </summary>
+		template<size_t v0, size_t v1, size_t v2, size_t v3>
+		inline const V8Bool Shuffle(const V8Bool& a){ return _mm256_permute_ps(a, _MM_SHUFFLE(v3, v2, v1, v0)); }
+		template<size_t a0, size_t a1, size_t b2, size_t b3>
+		inline const V8Bool Shuffle(const V8Bool& a, const V8Bool& b){ return _mm256_shuffle_ps(a, b, _MM_SHUFFLE(b3, b2, a1, a0)); }
+
+		inline bool All(const V8Bool& a) { return _mm256_movemask_ps(a) == 0xff; }
+		inline bool Any(const V8Bool& a) { return !_mm256_testz_ps(a, a); }
+		inline bool None(const V8Bool& a) { return _mm256_testz_ps(a, a) != 0; }
+	}
+}
+#endif
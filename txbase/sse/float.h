@@ -8,6 +8,9 @@
 #else
 	#include <smmintrin.h>
 	#include <xmmintrin.h>
+	#ifdef __FMA__
+		#include <immintrin.h>
+	#endif
 #endif
 
 #include "txbase/fwddecl.h"
@@ -57,7 +60,7 @@ namespace TX {
 			inline const V4Float operator + (const V4Float& ot) const { return _mm_add_ps(m, ot.m); }
 			inline const V4Float operator - (const V4Float& ot) const { return _mm_sub_ps(m, ot.m); }
 			inline const V4Float operator * (const V4Float& ot) const { return _mm_mul_ps(m, ot.m); }
-			inline const V4Float operator / (const V4Float& ot) const { return *this * _mm_rcp_ps(ot.m); }
+			inline const V4Float operator / (const V4Float& ot) const { return _mm_div_ps(m, ot.m); }
 			inline const V4Float operator + (float ot) const { return *this + V4Float(ot); }
 			inline const V4Float operator - (float ot) const { return *this - V4Float(ot); }
 			inline const V4Float operator * (float ot) const { return *this * V4Float(ot); }
@@ -105,9 +108,28 @@ namespace TX {
 
 		inline const V4Float ToRad(const V4Float& deg) { return deg * V4Float(0.0055555555555f) * V4Float::PI; }
 		inline const V4Float ToDeg(const V4Float& rad) { return rad * V4Float(180.f) * V4Float::PI_RCP; }
-		inline const V4Float Sin(V4Float& rad) { return sin_ps(rad.m); }
-		inline const V4Float Cos(V4Float& rad) { return cos_ps(rad.m); }
-		inline const V4Float Tan(V4Float& rad) { return Sin(rad) / Cos(rad); }
+		inline const V4Float Sin(const V4Float& rad) { return sin_ps(rad.m); }
+		inline const V4Float Cos(const V4Float& rad) { return cos_ps(rad.m); }
+		inline const V4Float Tan(const V4Float& rad) { V4Float s, c; sincos_ps(rad.m, &s.m, &c.m); return s / c; }
+
+		/// <summary>
+		/// Square root and reciprocal correctly rounded, reciprocal square root within 1.5 ulps.
+		/// </summary>
+		inline const V4Float Sqrt(const V4Float& v) { return _mm_sqrt_ps(v.m); }
+		inline const V4Float Rsqrt(const V4Float& v) { return _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(v.m)); }
+		inline const V4Float Rcp(const V4Float& v) { return _mm_div_ps(_mm_set1_ps(1.f), v.m); }
+		/// <summary>
+		/// The 12 bit hardware estimates refined by a Newton-Raphson step, within a few ulps for positive normal numbers.
+		/// </summary>
+		inline const V4Float RsqrtFast(const V4Float& v) {
+			const __m128 r = _mm_rsqrt_ps(v.m);
+			return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), v.m), _mm_mul_ps(r, r))));
+		}
+		inline const V4Float RcpFast(const V4Float& v) {
+			const __m128 r = _mm_rcp_ps(v.m);
+			return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.f), _mm_mul_ps(v.m, r)));
+		}
+		inline const V4Float SqrtFast(const V4Float& v) { return _mm_and_ps(_mm_mul_ps(v.m, RsqrtFast(v).m), _mm_cmpgt_ps(v.m, _mm_setzero_ps())); }
 
 		inline const V4Float Min(const V4Float& a, const V4Float& b) { return _mm_min_ps(a, b); }
 		inline const V4Float Max(const V4Float& a, const V4Float& b) { return _mm_max_ps(a, b); }
@@ -117,6 +139,31 @@ namespace TX {
 		template<bool n0, bool n1, bool n2, bool n3>
 		inline const V4Float Negate(const V4Float& v) { return _mm_xor_ps(v.m, SSE::SIGN_MASK[(n3 << 3) | (n2 << 2) | (n1 << 1) | n0]); }
 
+		/// <summary>
+		/// a * b + c, a * b - c and c - a * b, fused if built with FMA.
+		/// </summary>
+		inline const V4Float MulAdd(const V4Float& a, const V4Float& b, const V4Float& c) {
+#ifdef __FMA__
+			return _mm_fmadd_ps(a, b, c);
+#else
+			return a * b + c;
+#endif
+		}
+		inline const V4Float MulSub(const V4Float& a, const V4Float& b, const V4Float& c) {
+#ifdef __FMA__
+			return _mm_fmsub_ps(a, b, c);
+#else
+			return a * b - c;
+#endif
+		}
+		inline const V4Float NegMulAdd(const V4Float& a, const V4Float& b, const V4Float& c) {
+#ifdef __FMA__
+			return _mm_fnmadd_ps(a, b, c);
+#else
+			return c - a * b;
+#endif
+		}
+
 		inline const V4Float Select(const V4Bool& maska, const V4Float& a, const V4Float& b) { return _mm_blendv_ps(b.m, a.m, maska); }
 		inline const V4Float UnpackLow(const V4Float& a, const V4Float& b) { return _mm_unpacklo_ps(a.m, b.m); }
 		inline const V4Float UnpackHigh(const V4Float& a, const V4Float& b) { return _mm_unpackhi_ps(a.m, b.m); }
@@ -139,7 +186,18 @@ namespace TX {
 			//return __bsf(_mm_movemask_epi8(v == VReduceMin(v)));
 		}
 		inline int SelectMax(const V4Float& v) { return __bsf(_mm_movemask_ps(v == VReduceMax(v))); }
-		inline int SelectMin(const V4Bool& valid, const V4Float& v) { const V4Float f = Select(valid, v, V4Float::INF); return __bsf(_mm_movemask_ps(valid & (f == VReduceMin(f)))); }
-		inline int SelectMax(const V4Bool& valid, const V4Float& v) { const V4Float f = Select(valid, v, -V4Float::INF); return __bsf(_mm_movemask_ps(valid & (f == VReduceMax(f)))); }
+		/// <summary>
+		/// Lane of the smallest (largest) valid value, -1 if no lane is valid.
+		/// </summary>
+		inline int SelectMin(const V4Bool& valid, const V4Float& v) {
+			const V4Float f = Select(valid, v, V4Float::INF);
+			const uint32_t mask = _mm_movemask_ps(valid & (f == VReduceMin(f)));
+			return mask ? __bsf(mask) : -1;
+		}
+		inline int SelectMax(const V4Bool& valid, const V4Float& v) {
+			const V4Float f = Select(valid, v, -V4Float::INF);
+			const uint32_t mask = _mm_movemask_ps(valid & (f == VReduceMax(f)));
+			return mask ? __bsf(mask) : -1;
+		}
 	}
 }
@@ -0,0 +1,17 @@
+#include "txbase/stdafx.h"
+#include "float16.h"
+
+#ifdef __AVX512F__
+namespace TX
+{
+	namespace SSE
+	{
+		const V16Float V16Float::ZERO(0.f);
+		const V16Float V16Float::ONE(1.f);
+		const V16Float V16Float::PI(Math::PI);
+		const V16Float V16Float::PI_RCP(Math::PI_RCP);
+		const V16Float V16Float::INF(Math::INF);
+		const V16Float V16Float::EPSILON(Math::EPSILON);
+	}
+}
+#endif
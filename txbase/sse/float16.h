@@ -0,0 +1,170 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+#include "txbase/sse/float8.h"
+#include "txbase/sse/bool16.h"
+#include "txbase/sse/int16.h"
+
+#ifdef __AVX512F__
+namespace TX {
+	namespace SSE {
+		/// <summary>
+		/// Sixteen floats of AVX-512, with the operations of V8Float. Comparisons give V16Bool mask registers.
+		/// </summary>
+		struct V16Float {
+		public:
+			union {
+				__m512 m;
+				float v[16];
+			};
+			static const V16Float ZERO;
+			static const V16Float ONE;
+			static const V16Float PI;
+			static const V16Float PI_RCP;
+			static const V16Float INF;
+			static const V16Float EPSILON;
+		public:
+			inline V16Float() : m(_mm512_setzero_ps()) {}
+			inline V16Float(__m512 d) : m(d) {}
+			inline V16Float(const float& v) : m(_mm512_set1_ps(v)) {}
+			// masked forms with every lane set throughout, GCC's unmasked AVX-512 intrinsics pass an undefined source that -Wall reports
+			inline V16Float(const V8Float& lo, const V8Float& hi) : m(_mm512_castpd_ps(_mm512_mask_insertf64x4(
+				_mm512_setzero_pd(), 0xFF, _mm512_castpd256_pd512(_mm256_castps_pd(lo)), _mm256_castps_pd(hi), 1))) {}
+			inline explicit V16Float(const float *arr) : m(_mm512_loadu_ps(arr)) {}
+			inline V16Float(const V16Float& ot) : m(ot.m) {}
+
+			inline operator const __m512&(void) const { return m; }
+			inline operator       __m512&(void) { return m; }
+
+			inline V16Float& operator = (const V16Float& ot) { m = ot.m; return *this; }
+			inline const float& operator [] (const size_t i) const { return v[i]; }
+			inline		 float& operator [] (const size_t i)       { return v[i]; }
+
+			inline const V8Float Low() const { return _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, _mm512_castps_pd(m), 0)); }
+			inline const V8Float High() const { return _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, _mm512_castps_pd(m), 1)); }
+
+			inline const V16Float operator + () const { return *this; }
+			inline const V16Float operator - () const { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(m), _mm512_set1_epi32(0x80000000))); }
+
+			inline const V16Float operator + (const V16Float& ot) const { return _mm512_add_ps(m, ot.m); }
+			inline const V16Float operator - (const V16Float& ot) const { return _mm512_sub_ps(m, ot.m); }
+			inline const V16Float operator * (const V16Float& ot) const { return _mm512_mul_ps(m, ot.m); }
+			inline const V16Float operator / (const V16Float& ot) const { return _mm512_div_ps(m, ot.m); }
+			inline const V16Float operator + (float ot) const { return *this + V16Float(ot); }
+			inline const V16Float operator - (float ot) const { return *this - V16Float(ot); }
+			inline const V16Float operator * (float ot) const { return *this * V16Float(ot); }
+			inline const V16Float operator / (float ot) const { return *this * (1.0f / ot); }
+			inline V16Float& operator += (const V16Float& ot) { return *this = *this + ot; }
+			inline V16Float& operator += (const float& ot) { return *this = *this + ot; }
+			inline V16Float& operator -= (const V16Float& ot) { return *this = *this - ot; }
+			inline V16Float& operator -= (const float& ot) { return *this = *this - ot; }
+			inline V16Float& operator *= (const V16Float& ot) { return *this = *this * ot; }
+			inline V16Float& operator *= (const float& ot) { return *this = *this * ot; }
+			inline V16Float& operator /= (const V16Float& ot) { return *this = *this / ot; }
+			inline V16Float& operator /= (const float& ot) { return *this = *this / ot; }
+
+			inline const V16Bool operator == (const V16Float& ot) const { return _mm512_cmp_ps_mask(m, ot.m, _CMP_EQ_OQ); }
+			inline const V16Bool operator == (const float& ot) const { return *this == V16Float(ot); }
+			inline const V16Bool operator != (const V16Float& ot) const { return _mm512_cmp_ps_mask(m, ot.m, _CMP_NEQ_UQ); }
+			inline const V16Bool operator != (const float& ot) const { return *this != V16Float(ot); }
+			inline const V16Bool operator < (const V16Float& ot) const { return _mm512_cmp_ps_mask(m, ot.m, _CMP_LT_OS); }
+			inline const V16Bool operator < (const float& ot) const { return *this < V16Float(ot); }
+			inline const V16Bool operator > (const V16Float& ot) const { return _mm512_cmp_ps_mask(m, ot.m, _CMP_GT_OS); }
+			inline const V16Bool operator > (const float& ot) const { return *this > V16Float(ot); }
+			inline const V16Bool operator <= (const V16Float& ot) const { return _mm512_cmp_ps_mask(m, ot.m, _CMP_LE_OS); }
+			inline const V16Bool operator <= (const float& ot) const { return *this <= V16Float(ot); }
+			inline const V16Bool operator >= (const V16Float& ot) const { return _mm512_cmp_ps_mask(m, ot.m, _CMP_GE_OS); }
+			inline const V16Bool operator >= (const float& ot) const { return *this >= V16Float(ot); }
+
+			// bitwise operations of floats need AVX-512 DQ, these go through the integer ones
+			inline const V16Float operator & (const V16Float& ot) const { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(m), _mm512_castps_si512(ot.m))); }
+			inline const V16Float operator & (const V16Int& mask) const { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(m), mask.m)); }
+			inline const V16Float operator | (const V16Float& ot) const { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(m), _mm512_castps_si512(ot.m))); }
+			inline const V16Float operator | (const V16Int& mask) const { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(m), mask.m)); }
+			inline const V16Float operator ^ (const V16Float& ot) const { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(m), _mm512_castps_si512(ot.m))); }
+			inline const V16Float operator ^ (const V16Int& mask) const { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(m), mask.m)); }
+		};
+		inline V16Float operator * (float r, const V16Float& v) { return v * r; }
+		inline std::ostream& operator << (std::ostream& os, const V16Float& v) {
+			os << "(" << v.v[0];
+			for (int i = 1; i < 16; i++)
+				os << ", " << v.v[i];
+			return os << ")";
+		}
+
+		inline const V16Float Abs(const V16Float& v) { return _mm512_abs_ps(v.m); }
+
+		inline const V16Float Exp(const V16Float& v) { return V16Float(Exp(v.Low()), Exp(v.High())); }
+		inline const V16Float Log(const V16Float& v) { return V16Float(Log(v.Low()), Log(v.High())); }
+		inline const V16Float Log2(const V16Float& v) { return Log(v) * V16Float(1.4426950408890f); }
+		inline const V16Float Log10(const V16Float& v) { return Log(v) * V16Float(0.4342944819033f); }
+		inline const V16Float Pow(const V16Float& v, const V16Float& e) { return Exp(e * Log(v)); }
+
+		inline const V16Float ToRad(const V16Float& deg) { return deg * V16Float(0.0055555555555f) * V16Float::PI; }
+		inline const V16Float ToDeg(const V16Float& rad) { return rad * V16Float(180.f) * V16Float::PI_RCP; }
+		inline const V16Float Sin(const V16Float& rad) { return V16Float(Sin(rad.Low()), Sin(rad.High())); }
+		inline const V16Float Cos(const V16Float& rad) { return V16Float(Cos(rad.Low()), Cos(rad.High())); }
+		inline const V16Float Tan(const V16Float& rad) { return Sin(rad) / Cos(rad); }
+
+		/// <summary>
+		/// Square root and reciprocal correctly rounded, reciprocal square root within 1.5 ulps.
+		/// </summary>
+		inline const V16Float Sqrt(const V16Float& v) { return _mm512_maskz_sqrt_ps(0xFFFF, v.m); }
+		inline const V16Float Rsqrt(const V16Float& v) { return _mm512_div_ps(_mm512_set1_ps(1.f), _mm512_maskz_sqrt_ps(0xFFFF, v.m)); }
+		inline const V16Float Rcp(const V16Float& v) { return _mm512_div_ps(_mm512_set1_ps(1.f), v.m); }
+		/// <summary>
+		/// The 14 bit hardware estimates refined by a Newton-Raphson step, within a few ulps for positive normal numbers.
+		/// </summary>
+		inline const V16Float RsqrtFast(const V16Float& v) {
+			const __m512 r = _mm512_maskz_rsqrt14_ps(0xFFFF, v.m);
+			return _mm512_mul_ps(r, _mm512_fnmadd_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), v.m), _mm512_mul_ps(r, r), _mm512_set1_ps(1.5f)));
+		}
+		inline const V16Float RcpFast(const V16Float& v) {
+			const __m512 r = _mm512_maskz_rcp14_ps(0xFFFF, v.m);
+			return _mm512_mul_ps(r, _mm512_fnmadd_ps(v.m, r, _mm512_set1_ps(2.f)));
+		}
+		inline const V16Float SqrtFast(const V16Float& v) { return _mm512_maskz_mul_ps(_mm512_cmp_ps_mask(v.m, _mm512_setzero_ps(), _CMP_GT_OQ), v.m, RsqrtFast(v).m); }
+
+		inline const V16Float Min(const V16Float& a, const V16Float& b) { return _mm512_maskz_min_ps(0xFFFF, a, b); }
+		inline const V16Float Max(const V16Float& a, const V16Float& b) { return _mm512_maskz_max_ps(0xFFFF, a, b); }
+		inline const V16Float Floor(const V16Float& v) { return _mm512_maskz_roundscale_ps(0xFFFF, v.m, _MM_FROUND_TO_NEG_INF); }
+		inline const V16Float Ceil(const V16Float& v) { return _mm512_maskz_roundscale_ps(0xFFFF, v.m, _MM_FROUND_TO_POS_INF); }
+		inline const V16Float Round(const V16Float& v) { return _mm512_maskz_roundscale_ps(0xFFFF, v.m, _MM_FROUND_TO_NEAREST_INT); }
+
+		/// <summary>
+		/// a * b + c, a * b - c and -(a * b) + c, always fused.
+		/// </summary>
+		inline const V16Float MulAdd(const V16Float& a, const V16Float& b, const V16Float& c) { return _mm512_fmadd_ps(a, b, c); }
+		inline const V16Float MulSub(const V16Float& a, const V16Float& b, const V16Float& c) { return _mm512_fmsub_ps(a, b, c); }
+		inline const V16Float NegMulAdd(const V16Float& a, const V16Float& b, const V16Float& c) { return _mm512_fnmadd_ps(a, b, c); }
+
+		inline const V16Float Select(const V16Bool& maska, const V16Float& a, const V16Float& b) { return _mm512_mask_blend_ps(maska, b.m, a.m); }
+
+		inline const float ReduceMin(const V16Float& v) { return ReduceMin(Min(v.Low(), v.High())); }
+		inline const float ReduceMax(const V16Float& v) { return ReduceMax(Max(v.Low(), v.High())); }
+		inline const float ReduceAdd(const V16Float& v) { return ReduceAdd(v.Low() + v.High()); }
+		inline int SelectMin(const V16Float& v) { return __bsf(v == V16Float(ReduceMin(v))); }
+		inline int SelectMax(const V16Float& v) { return __bsf(v == V16Float(ReduceMax(v))); }
+		/// <summary>
+		/// Lane of the smallest (largest) valid value, -1 if no lane is valid.
+		/// </summary>
+		inline int SelectMin(const V16Bool& valid, const V16Float& v) {
+			const V16Float f = Select(valid, v, V16Float::INF);
+			const uint32_t mask = valid & (f == V16Float(ReduceMin(f)));
+			return mask ? __bsf(mask) : -1;
+		}
+		inline int SelectMax(const V16Bool& valid, const V16Float& v) {
+			const V16Float f = Select(valid, v, -V16Float::INF);
+			const uint32_t mask = valid & (f == V16Float(ReduceMax(f)));
+			return mask ? __bsf(mask) : -1;
+		}
+	}
+}
+#endif
@@ -0,0 +1,17 @@
+#include "txbase/stdafx.h"
+#include "float8.h"
+
+#ifdef __AVX2__
+namespace TX
+{
+	namespace SSE
+	{
+		const V8Float V8Float::ZERO(0.f);
+		const V8Float V8Float::ONE(1.f);
+		const V8Float V8Float::PI(Math::PI);
+		const V8Float V8Float::PI_RCP(Math::PI_RCP);
+		const V8Float V8Float::INF(Math::INF);
+		const V8Float V8Float::EPSILON(Math::EPSILON);
+	}
+}
+#endif
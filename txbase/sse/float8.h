@@ -0,0 +1,211 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+#include "txbase/sse/float.h"
+#include "txbase/sse/bool8.h"
+#include "txbase/sse/int8.h"
+
+#ifdef __AVX2__
+namespace TX {
+	namespace SSE {
+		/// <summary>
+		/// Eight floats of AVX, with the operations of V4Float.
+		/// </summary>
+		struct V8Float {
+		public:
+			union {
+				__m256 m;
+				float v[8];
+			};
+			static const V8Float ZERO;
+			static const V8Float ONE;
+			static const V8Float PI;
+			static const V8Float PI_RCP;
+			static const V8Float INF;
+			static const V8Float EPSILON;
+		public:
+			inline V8Float() : m(_mm256_setzero_ps()) {}
+			inline V8Float(__m256 d) : m(d) {}
+			inline V8Float(const float& v) : m(_mm256_set1_ps(v)) {}
+			inline V8Float(float a, float b, float c, float d, float e, float f, float g, float h) : m(_mm256_setr_ps(a, b, c, d, e, f, g, h)) {}
+			inline V8Float(const V4Float& lo, const V4Float& hi) : m(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1)) {}
+			inline explicit V8Float(const float *arr) : m(_mm256_loadu_ps(arr)) {}
+			inline V8Float(const V8Float& ot) : m(ot.m) {}
+
+			inline operator const __m256&(void) const { return m; }
+			inline operator       __m256&(void) { return m; }
+
+			inline V8Float& operator = (const V8Float& ot) { m = ot.m; return *this; }
+			inline const float& operator [] (const size_t i) const { return v[i]; }
+			inline		 float& operator [] (const size_t i)       { return v[i]; }
+
+			inline const V4Float Low() const { return _mm256_castps256_ps128(m); }
+			inline const V4Float High() const { return _mm256_extractf128_ps(m, 1); }
+
+			inline const V8Float operator + () const { return *this; }
+			inline const V8Float operator - () const { return _mm256_xor_ps(m, _mm256_set1_ps(-0.f)); }
+
+			inline const V8Float operator + (const V8Float& ot) const { return _mm256_add_ps(m, ot.m); }
+			inline const V8Float operator - (const V8Float& ot) const { return _mm256_sub_ps(m, ot.m); }
+			inline const V8Float operator * (const V8Float& ot) const { return _mm256_mul_ps(m, ot.m); }
+			inline const V8Float operator / (const V8Float& ot) const { return _mm256_div_ps(m, ot.m); }
+			inline const V8Float operator + (float ot) const { return *this + V8Float(ot); }
+			inline const V8Float operator - (float ot) const { return *this - V8Float(ot); }
+			inline const V8Float operator * (float ot) const { return *this * V8Float(ot); }
+			inline const V8Float operator / (float ot) const { return *this * (1.0f / ot); }
+			inline V8Float& operator += (const V8Float& ot) { return *this = *this + ot; }
+			inline V8Float& operator += (const float& ot) { return *this = *this + ot; }
+			inline V8Float& operator -= (const V8Float& ot) { return *this = *this - ot; }
+			inline V8Float& operator -= (const float& ot) { return *this = *this - ot; }
+			inline V8Float& operator *= (const V8Float& ot) { return *this = *this * ot; }
+			inline V8Float& operator *= (const float& ot) { return *this = *this * ot; }
+			inline V8Float& operator /= (const V8Float& ot) { return *this = *this / ot; }
+			inline V8Float& operator /= (const float& ot) { return *this = *this / ot; }
+
+			inline const V8Bool operator == (const V8Float& ot) const { return _mm256_cmp_ps(m, ot.m, _CMP_EQ_OQ); }
+			inline const V8Bool operator == (const float& ot) const { return *this == V8Float(ot); }
+			inline const V8Bool operator != (const V8Float& ot) const { return _mm256_cmp_ps(m, ot.m, _CMP_NEQ_UQ); }
+			inline const V8Bool operator != (const float& ot) const { return *this != V8Float(ot); }
+			inline const V8Bool operator < (const V8Float& ot) const { return _mm256_cmp_ps(m, ot.m, _CMP_LT_OS); }
+			inline const V8Bool operator < (const float& ot) const { return *this < V8Float(ot); }
+			inline const V8Bool operator > (const V8Float& ot) const { return _mm256_cmp_ps(m, ot.m, _CMP_GT_OS); }
+			inline const V8Bool operator > (const float& ot) const { return *this > V8Float(ot); }
+			inline const V8Bool operator <= (const V8Float& ot) const { return _mm256_cmp_ps(m, ot.m, _CMP_LE_OS); }
+			inline const V8Bool operator <= (const float& ot) const { return *this <= V8Float(ot); }
+			inline const V8Bool operator >= (const V8Float& ot) const { return _mm256_cmp_ps(m, ot.m, _CMP_GE_OS); }
+			inline const V8Bool operator >= (const float& ot) const { return *this >= V8Float(ot); }
+
+			inline const V8Float operator & (const V8Float& ot) const { return _mm256_and_ps(m, ot.m); }
+			inline const V8Float operator & (const V8Int& mask) const { return _mm256_and_ps(m, _mm256_castsi256_ps(mask.m)); }
+			inline const V8Float operator | (const V8Float& ot) const { return _mm256_or_ps(m, ot.m); }
+			inline const V8Float operator | (const V8Int& mask) const { return _mm256_or_ps(m, _mm256_castsi256_ps(mask.m)); }
+			inline const V8Float operator ^ (const V8Float& ot) const { return _mm256_xor_ps(m, ot.m); }
+			inline const V8Float operator ^ (const V8Int& mask) const { return _mm256_xor_ps(m, _mm256_castsi256_ps(mask.m)); }
+		};
+		inline V8Float operator * (float r, const V8Float& v) { return v * r; }
+		inline std::ostream& operator << (std::ostream& os, const V8Float& v) {
+			os << "(" << v.v[0];
+			for (int i = 1; i < 8; i++)
+				os << ", " << v.v[i];
+			return os << ")";
+		}
+
+		inline const V8Float Abs(const V8Float& v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), v.m); }
+		// there are only 128 bit versions of these, applied to both halves
+		inline const V8Float Exp(const V8Float& v) { return V8Float(exp_ps(v.Low()), exp_ps(v.High())); }
+		inline const V8Float Log(const V8Float& v) { return V8Float(log_ps(v.Low()), log_ps(v.High())); }
+		inline const V8Float Log2(const V8Float& v) { return Log(v) * V8Float(1.4426950408890f); }
+		inline const V8Float Log10(const V8Float& v) { return Log(v) * V8Float(0.4342944819033f); }
+		inline const V8Float Pow(const V8Float& v, const V8Float& e) { return Exp(e * Log(v)); }
+
+		inline const V8Float ToRad(const V8Float& deg) { return deg * V8Float(0.0055555555555f) * V8Float::PI; }
+		inline const V8Float ToDeg(const V8Float& rad) { return rad * V8Float(180.f) * V8Float::PI_RCP; }
+		inline const V8Float Sin(const V8Float& rad) { return V8Float(sin_ps(rad.Low()), sin_ps(rad.High())); }
+		inline const V8Float Cos(const V8Float& rad) { return V8Float(cos_ps(rad.Low()), cos_ps(rad.High())); }
+		inline const V8Float Tan(const V8Float& rad) { return Sin(rad) / Cos(rad); }
+
+		/// <summary>
+		/// Square root and reciprocal correctly rounded, reciprocal square root within 1.5 ulps.
+		/// </summary>
+		inline const V8Float Sqrt(const V8Float& v) { return _mm256_sqrt_ps(v.m); }
+		inline const V8Float Rsqrt(const V8Float& v) { return _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(v.m)); }
+		inline const V8Float Rcp(const V8Float& v) { return _mm256_div_ps(_mm256_set1_ps(1.f), v.m); }
+		/// <summary>
+		/// The 12 bit hardware estimates refined by a Newton-Raphson step, within a few ulps for positive normal numbers.
+		/// </summary>
+		inline const V8Float RsqrtFast(const V8Float& v) {
+			const __m256 r = _mm256_rsqrt_ps(v.m);
+			return _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), v.m), _mm256_mul_ps(r, r))));
+		}
+		inline const V8Float RcpFast(const V8Float& v) {
+			const __m256 r = _mm256_rcp_ps(v.m);
+			return _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(2.f), _mm256_mul_ps(v.m, r)));
+		}
+		inline const V8Float SqrtFast(const V8Float& v) { return _mm256_and_ps(_mm256_mul_ps(v.m, RsqrtFast(v).m), _mm256_cmp_ps(v.m, _mm256_setzero_ps(), _CMP_GT_OQ)); }
+
+		inline const V8Float Min(const V8Float& a, const V8Float& b) { return _mm256_min_ps(a, b); }
+		inline const V8Float Max(const V8Float& a, const V8Float& b) { return _mm256_max_ps(a, b); }
+		inline const V8Float Floor(const V8Float& v) { return _mm256_round_ps(v.m, _MM_FROUND_TO_NEG_INF); }
+		inline const V8Float Ceil(const V8Float& v) { return _mm256_round_ps(v.m, _MM_FROUND_TO_POS_INF); }
+		inline const V8Float Round(const V8Float& v) { return _mm256_round_ps(v.m, _MM_FROUND_TO_NEAREST_INT); }
+		template<bool n0, bool n1, bool n2, bool n3, bool n4, bool n5, bool n6, bool n7>
+		inline const V8Float Negate(const V8Float& v) {
+			return _mm256_xor_ps(v.m, _mm256_setr_ps(
+				n0 ? -0.f : 0.f, n1 ? -0.f : 0.f, n2 ? -0.f : 0.f, n3 ? -0.f : 0.f,
+				n4 ? -0.f : 0.f, n5 ? -0.f : 0.f, n6 ? -0.f : 0.f, n7 ? -0.f : 0.f));
+		}
+
+		/// <summary>
+		/// a * b + c, a * b - c and c - a * b, fused if built with FMA.
+		/// </summary>
+		inline const V8Float MulAdd(const V8Float& a, const V8Float& b, const V8Float& c) {
+#ifdef __FMA__
+			return _mm256_fmadd_ps(a, b, c);
+#else
+			return a * b + c;
+#endif
+		}
+		inline const V8Float MulSub(const V8Float& a, const V8Float& b, const V8Float& c) {
+#ifdef __FMA__
+			return _mm256_fmsub_ps(a, b, c);
+#else
+			return a * b - c;
+#endif
+		}
+		inline const V8Float NegMulAdd(const V8Float& a, const V8Float& b, const V8Float& c) {
+#ifdef __FMA__
+			return _mm256_fnmadd_ps(a, b, c);
+#else
+			return c - a * b;
+#endif
+		}
+
+		inline const V8Float Select(const V8Bool& maska, const V8Float& a, const V8Float& b) { return _mm256_blendv_ps(b.m, a.m, maska); }
+		/// <summary>
+		/// Interleave within each half, like the 128 bit versions applied to both halves.
+		/// </summary>
+		inline const V8Float UnpackLow(const V8Float& a, const V8Float& b) { return _mm256_unpacklo_ps(a.m, b.m); }
+		inline const V8Float UnpackHigh(const V8Float& a, const V8Float& b) { return _mm256_unpackhi_ps(a.m, b.m); }
+		/// <summary>
+		/// Shuffles each half with the same pattern.
+		/// </summary>
+		template<size_t v0, size_t v1, size_t v2, size_t v3>
+		inline const V8Float Shuffle(const V8Float& v) { return _mm256_permute_ps(v, _MM_SHUFFLE(v3, v2, v1, v0)); }
+		template<size_t a0, size_t a1, size_t b2, size_t b3>
+		inline const V8Float Shuffle(const V8Float& a, const V8Float& b) { return _mm256_shuffle_ps(a, b, _MM_SHUFFLE(b3, b2, a1, a0)); }
+		/// <summary>
+		/// Swaps the halves.
+		/// </summary>
+		inline const V8Float SwapHalves(const V8Float& v) { return _mm256_permute2f128_ps(v, v, 1); }
+
+		inline const V8Float VReduceMin(const V8Float& v) { V8Float h = Min(Shuffle<1, 0, 3, 2>(v), v); h = Min(Shuffle<2, 3, 0, 1>(h), h); return Min(SwapHalves(h), h); }
+		inline const V8Float VReduceMax(const V8Float& v) { V8Float h = Max(Shuffle<1, 0, 3, 2>(v), v); h = Max(Shuffle<2, 3, 0, 1>(h), h); return Max(SwapHalves(h), h); }
+		inline const V8Float VReduceAdd(const V8Float& v) { V8Float h = Shuffle<1, 0, 3, 2>(v) + v; h = Shuffle<2, 3, 0, 1>(h) + h; return SwapHalves(h) + h; }
+		inline const float ReduceMin(const V8Float& v) { return _mm256_cvtss_f32(VReduceMin(v)); }
+		inline const float ReduceMax(const V8Float& v) { return _mm256_cvtss_f32(VReduceMax(v)); }
+		inline const float ReduceAdd(const V8Float& v) { return _mm256_cvtss_f32(VReduceAdd(v)); }
+		inline int SelectMin(const V8Float& v) { return __bsf(_mm256_movemask_ps(v == VReduceMin(v))); }
+		inline int SelectMax(const V8Float& v) { return __bsf(_mm256_movemask_ps(v == VReduceMax(v))); }
+		/// <summary>
+		/// Lane of the smallest (largest) valid value, -1 if no lane is valid.
+		/// </summary>
+		inline int SelectMin(const V8Bool& valid, const V8Float& v) {
+			const V8Float f = Select(valid, v, V8Float::INF);
+			const uint32_t mask = _mm256_movemask_ps(valid & (f == VReduceMin(f)));
+			return mask ? __bsf(mask) : -1;
+		}
+		inline int SelectMax(const V8Bool& valid, const V8Float& v) {
+			const V8Float f = Select(valid, v, -V8Float::INF);
+			const uint32_t mask = _mm256_movemask_ps(valid & (f == VReduceMax(f)));
+			return mask ? __bsf(mask) : -1;
+		}
+	}
+}
+#endif
@@ -97,6 +97,7 @@ namespace TX
 		inline const V4Int Negate(const V4Int& v){ return _mm_xor_si128(v.m, _mm_castps_si128(SSE::SIGN_MASK[(n3 << 3) | (n2 << 2) | (n1 << 1) | n0])); }
 
 		inline const V4Int Select(const V4Int& a, const V4Int& b, const V4Bool& fb){ return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a), fb)); }
+		inline const V4Int Select(const V4Bool& maska, const V4Int& a, const V4Int& b){ return Select(a, b, maska); }
 		inline V4Int UnpackLow(const V4Int& a, const V4Int& b) { return _mm_unpacklo_epi32(a.m, b.m); }
 		inline V4Int UnpackHigh(const V4Int& a, const V4Int& b) { return _mm_unpackhi_epi32(a.m, b.m); }
 
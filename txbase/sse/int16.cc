@@ -0,0 +1,13 @@
+#include "txbase/stdafx.h"
+#include "int16.h"
+
+#ifdef __AVX512F__
+namespace TX
+{
+	namespace SSE
+	{
+		const V16Int V16Int::ZERO(0);
+		const V16Int V16Int::ONE(1);
+	}
+}
+#endif
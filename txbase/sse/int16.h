@@ -0,0 +1,104 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+#include "txbase/sse/int8.h"
+#include "txbase/sse/bool16.h"
+
+#ifdef __AVX512F__
+namespace TX
+{
+	namespace SSE
+	{
+		struct V16Int {
+		public:
+			union{
+				__m512i m;
+				int32_t v[16];
+			};
+			static const V16Int ZERO;
+			static const V16Int ONE;
+		public:
+			inline V16Int() : m(_mm512_setzero_si512()) {}
+			inline V16Int(__m512i mi) : m(mi) {}
+			inline V16Int(const V16Int& ot) : m(ot.m) {}
+			// masked forms with every lane set throughout, GCC's unmasked AVX-512 intrinsics pass an undefined source that -Wall reports
+			inline V16Int(const V8Int& lo, const V8Int& hi) : m(_mm512_mask_inserti64x4(_mm512_setzero_si512(), 0xFF, _mm512_castsi256_si512(lo), hi, 1)) {}
+			inline V16Int(int32_t a) : m(_mm512_set1_epi32(a)){}
+			inline explicit V16Int(const int32_t *arr) : m(_mm512_loadu_si512(arr)) {}
+
+			inline explicit V16Int(__m512 m) : m(_mm512_maskz_cvtps_epi32(0xFFFF, m)) {}
+			inline V16Int& operator = (const V16Int& ot){ m = ot.m; return *this; }
+
+			inline operator const __m512i&(void) const { return m; }
+			inline operator       __m512i&(void)       { return m; }
+
+			inline const int32_t& operator [] (const size_t idx) const { return v[idx]; }
+			inline       int32_t& operator [] (const size_t idx)       { return v[idx]; }
+
+			inline const V8Int Low() const { return _mm512_maskz_extracti64x4_epi64(0xFF, m, 0); }
+			inline const V8Int High() const { return _mm512_maskz_extracti64x4_epi64(0xFF, m, 1); }
+
+			inline const V16Int operator + () const { return *this; }
+			inline const V16Int operator - () const { return _mm512_sub_epi32(_mm512_setzero_si512(), m); }
+			inline const V16Int operator + (const V16Int& ot) const { return _mm512_add_epi32(m, ot.m); }
+			inline const V16Int operator + (const int32_t& ot) const { return *this + V16Int(ot); }
+			inline const V16Int operator - (const V16Int& ot) const { return _mm512_sub_epi32(m, ot.m); }
+			inline const V16Int operator - (const int32_t& ot) const { return *this - V16Int(ot); }
+			inline const V16Int operator * (const V16Int& ot) const { return _mm512_mullo_epi32(m, ot.m); }
+			inline const V16Int operator * (const int32_t& ot) const { return *this * V16Int(ot); }
+			inline const V16Int operator & (const V16Int& ot) const { return _mm512_and_si512(m, ot.m); }
+			inline const V16Int operator & (const int32_t& ot) const { return *this & V16Int(ot); }
+			inline const V16Int operator | (const V16Int& ot) const { return _mm512_or_si512(m, ot.m); }
+			inline const V16Int operator | (const int32_t& ot) const { return *this | V16Int(ot); }
+			inline const V16Int operator ^ (const V16Int& ot) const { return _mm512_xor_si512(m, ot.m); }
+			inline const V16Int operator ^ (const int32_t& ot) const { return *this ^ V16Int(ot); }
+			inline const V16Int operator << (const int32_t& n) const { return _mm512_maskz_slli_epi32(0xFFFF, m, n); }
+			inline const V16Int operator >> (const int32_t& n) const { return _mm512_maskz_srai_epi32(0xFFFF, m, n); }
+
+			inline V16Int& operator += (const V16Int& ot) { return *this = *this + ot; }
+			inline V16Int& operator += (const int32_t& ot) { return *this = *this + ot; }
+			inline V16Int& operator -= (const V16Int& ot) { return *this = *this - ot; }
+			inline V16Int& operator -= (const int32_t& ot) { return *this = *this - ot; }
+			inline V16Int& operator *= (const V16Int& ot) { return *this = *this * ot; }
+			inline V16Int& operator *= (const int32_t& ot) { return *this = *this * ot; }
+			inline V16Int& operator &= (const V16Int& ot) { return *this = *this & ot; }
+			inline V16Int& operator |= (const V16Int& ot) { return *this = *this | ot; }
+			inline V16Int& operator <<= (const int32_t& ot) { return *this = *this << ot; }
+			inline V16Int& operator >>= (const int32_t& ot) { return *this = *this >> ot; }
+
+			inline const V16Bool operator == (const V16Int& ot) const { return _mm512_cmpeq_epi32_mask(m, ot.m); }
+			inline const V16Bool operator == (const int32_t& ot) const { return *this == V16Int(ot); }
+			inline const V16Bool operator != (const V16Int& ot) const { return _mm512_cmpneq_epi32_mask(m, ot.m); }
+			inline const V16Bool operator != (const int32_t& ot) const { return *this != V16Int(ot); }
+			inline const V16Bool operator < (const V16Int& ot) const { return _mm512_cmplt_epi32_mask(m, ot.m); }
+			inline const V16Bool operator < (const int32_t& ot) const { return *this < V16Int(ot); }
+			inline const V16Bool operator >= (const V16Int& ot) const { return _mm512_cmpge_epi32_mask(m, ot.m); }
+			inline const V16Bool operator >= (const int32_t& ot) const { return *this >= V16Int(ot); }
+			inline const V16Bool operator > (const V16Int& ot) const { return _mm512_cmpgt_epi32_mask(m, ot.m); }
+			inline const V16Bool operator > (const int32_t& ot) const { return *this > V16Int(ot); }
+			inline const V16Bool operator <= (const V16Int& ot) const { return _mm512_cmple_epi32_mask(m, ot.m); }
+			inline const V16Bool operator <= (const int32_t& ot) const { return *this <= V16Int(ot); }
+		};
+
+		inline std::ostream& operator << (std::ostream& os, const V16Int& v) {
+			os << "(" << v.v[0];
+			for (int i = 1; i < 16; i++)
+				os << ", " << v.v[i];
+			return os << ")";
+		}
+
+		inline const V16Int Abs(const V16Int& v) { return _mm512_maskz_abs_epi32(0xFFFF, v.m); }
+		inline const V16Int Min(const V16Int& a, const V16Int& b) { return _mm512_maskz_min_epi32(0xFFFF, a.m, b.m); }
+		inline const V16Int Max(const V16Int& a, const V16Int& b) { return _mm512_maskz_max_epi32(0xFFFF, a.m, b.m); }
+
+		inline const V16Int Select(const V16Bool& maska, const V16Int& a, const V16Int& b){ return _mm512_mask_blend_epi32(maska, b.m, a.m); }
+	}
+}
+#endif
@@ -0,0 +1,13 @@
+#include "txbase/stdafx.h"
+#include "int8.h"
+
+#ifdef __AVX2__
+namespace TX
+{
+	namespace SSE
+	{
+		const V8Int V8Int::ZERO(0);
+		const V8Int V8Int::ONE(1);
+	}
+}
+#endif
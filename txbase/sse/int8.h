@@ -0,0 +1,128 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+#include "txbase/sse/int.h"
+#include "txbase/sse/bool8.h"
+
+#ifdef __AVX2__
+namespace TX
+{
+	namespace SSE
+	{
+		struct V8Int {
+		public:
+			union{
+				__m256i m;
+				int32_t v[8];
+			};
+			static const V8Int ZERO;
+			static const V8Int ONE;
+		public:
+			inline V8Int() : m(_mm256_setzero_si256()) {}
+			inline V8Int(__m256i mi) : m(mi) {}
+			inline V8Int(const V8Int& ot) : m(ot.m) {}
+			inline V8Int(const V4Int& lo, const V4Int& hi) : m(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1)) {}
+			inline V8Int(int32_t a) : m(_mm256_set1_epi32(a)){}
+			inline V8Int(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f, int32_t g, int32_t h) :
+				m(_mm256_setr_epi32(a, b, c, d, e, f, g, h)){}
+			inline explicit V8Int(const int32_t *arr) : m(_mm256_loadu_si256((const __m256i *)arr)) {}
+
+			inline explicit V8Int(__m256 m) : m(_mm256_cvtps_epi32(m)) {}
+			inline V8Int& operator = (const V8Int& ot){ m = ot.m; return *this; }
+
+			inline operator const __m256i&(void) const { return m; }
+			inline operator       __m256i&(void)       { return m; }
+
+			inline const int32_t& operator [] (const size_t idx) const { return v[idx]; }
+			inline       int32_t& operator [] (const size_t idx)       { return v[idx]; }
+
+			inline const V4Int Low() const { return _mm256_castsi256_si128(m); }
+			inline const V4Int High() const { return _mm256_extracti128_si256(m, 1); }
+
+			inline const V8Int operator + () const { return *this; }
+			inline const V8Int operator - () const { return _mm256_sub_epi32(_mm256_setzero_si256(), m); }
+			inline const V8Int operator + (const V8Int& ot) const { return _mm256_add_epi32(m, ot.m); }
+			inline const V8Int operator + (const int32_t& ot) const { return *this + V8Int(ot); }
+			inline const V8Int operator - (const V8Int& ot) const { return _mm256_sub_epi32(m, ot.m); }
+			inline const V8Int operator - (const int32_t& ot) const { return *this - V8Int(ot); }
+			inline const V8Int operator * (const V8Int& ot) const { return _mm256_mullo_epi32(m, ot.m); }
+			inline const V8Int operator * (const int32_t& ot) const { return *this * V8Int(ot); }
+			inline const V8Int operator & (const V8Int& ot) const { return _mm256_and_si256(m, ot.m); }
+			inline const V8Int operator & (const int32_t& ot) const { return *this & V8Int(ot); }
+			inline const V8Int operator | (const V8Int& ot) const { return _mm256_or_si256(m, ot.m); }
+			inline const V8Int operator | (const int32_t& ot) const { return *this | V8Int(ot); }
+			inline const V8Int operator ^ (const V8Int& ot) const { return _mm256_xor_si256(m, ot.m); }
+			inline const V8Int operator ^ (const int32_t& ot) const { return *this ^ V8Int(ot); }
+			inline const V8Int operator << (const int32_t& n) const { return _mm256_slli_epi32(m, n); }
+			inline const V8Int operator >> (const int32_t& n) const { return _mm256_srai_epi32(m, n); }
+
+			inline V8Int& operator += (const V8Int& ot) { return *this = *this + ot; }
+			inline V8Int& operator += (const int32_t& ot) { return *this = *this + ot; }
+			inline V8Int& operator -= (const V8Int& ot) { return *this = *this - ot; }
+			inline V8Int& operator -= (const int32_t& ot) { return *this = *this - ot; }
+			inline V8Int& operator *= (const V8Int& ot) { return *this = *this * ot; }
+			inline V8Int& operator *= (const int32_t& ot) { return *this = *this * ot; }
+			inline V8Int& operator &= (const V8Int& ot) { return *this = *this & ot; }
+			inline V8Int& operator &= (const int32_t& ot) { return *this = *this & ot; }
+			inline V8Int& operator |= (const V8Int& ot) { return *this = *this | ot; }
+			inline V8Int& operator |= (const int32_t& ot) { return *this = *this | ot; }
+			inline V8Int& operator <<= (const int32_t& ot) { return *this = *this << ot; }
+			inline V8Int& operator >>= (const int32_t& ot) { return *this = *this >> ot; }
+
+			inline const V8Bool operator == (const V8Int& ot) const { return _mm256_cmpeq_epi32(m, ot.m); }
+			inline const V8Bool operator == (const int32_t& ot) const { return *this == V8Int(ot); }
+			inline const V8Bool operator != (const V8Int& ot) const { return !(*this == ot); }
+			inline const V8Bool operator != (const int32_t& ot) const { return *this != V8Int(ot); }
+			inline const V8Bool operator < (const V8Int& ot) const { return _mm256_cmpgt_epi32(ot.m, m); }
+			inline const V8Bool operator < (const int32_t& ot) const { return *this < V8Int(ot); }
+			inline const V8Bool operator >= (const V8Int& ot) const { return !(*this < ot); }
+			inline const V8Bool operator >= (const int32_t& ot) const { return *this >= V8Int(ot); }
+			inline const V8Bool operator > (const V8Int& ot) const { return _mm256_cmpgt_epi32(m, ot.m); }
+			inline const V8Bool operator > (const int32_t& ot) const { return *this > V8Int(ot); }
+			inline const V8Bool operator <= (const V8Int& ot) const { return !(*this > ot); }
+			inline const V8Bool operator <= (const int32_t& ot) const { return *this <= V8Int(ot); }
+		};
+
+		inline std::ostream& operator << (std::ostream& os, const V8Int& v) {
+			os << "(" << v.v[0];
+			for (int i = 1; i < 8; i++)
+				os << ", " << v.v[i];
+			return os << ")";
+		}
+
+		inline const V8Int Abs(const V8Int& v) { return _mm256_abs_epi32(v.m); }
+		inline const V8Int Min(const V8Int& a, const V8Int& b) { return _mm256_min_epi32(a.m, b.m); }
+		inline const V8Int Max(const V8Int& a, const V8Int& b) { return _mm256_max_epi32(a.m, b.m); }
+
+		template<bool n0, bool n1, bool n2, bool n3, bool n4, bool n5, bool n6, bool n7>
+		inline const V8Int Negate(const V8Int& v){
+			return _mm256_xor_si256(v.m, _mm256_setr_epi32(
+				n0 ? 0x80000000 : 0, n1 ? 0x80000000 : 0, n2 ? 0x80000000 : 0, n3 ? 0x80000000 : 0,
+				n4 ? 0x80000000 : 0, n5 ? 0x80000000 : 0, n6 ? 0x80000000 : 0, n7 ? 0x80000000 : 0));
+		}
+
+		inline const V8Int Select(const V8Int& a, const V8Int& b, const V8Bool& fb){ return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), fb)); }
+		inline const V8Int Select(const V8Bool& maska, const V8Int& a, const V8Int& b){ return Select(a, b, maska); }
+		/// <summary>
+		/// Interleave within each half, like the 128 bit versions applied to both halves.
+		/// </summary>
+		inline V8Int UnpackLow(const V8Int& a, const V8Int& b) { return _mm256_unpacklo_epi32(a.m, b.m); }
+		inline V8Int UnpackHigh(const V8Int& a, const V8Int& b) { return _mm256_unpackhi_epi32(a.m, b.m); }
+
+		/// <summary>
+		/// Shuffles each half with the same pattern.
+		/// </summary>
+		template<size_t v0, size_t v1, size_t v2, size_t v3>
+		inline const V8Int Shuffle(const V8Int& a){ return _mm256_shuffle_epi32(a, _MM_SHUFFLE(v3, v2, v1, v0)); }
+		template<size_t a0, size_t a1, size_t b2, size_t b3>
+		inline const V8Int Shuffle(const V8Int& a, const V8Int& b){ return _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(b3, b2, a1, a0))); }
+	}
+}
+#endif
@@ -0,0 +1,116 @@
+#include "txbase/stdafx.h"
+#include "txbase/sse/kernels.h"
+#include "txbase/sse/soa.h"
+
+namespace TX
+{
+	// levels above the baseline, see kernels_avx.cc
+	KernelTable KernelsAVX2();
+	KernelTable KernelsAVX512();
+
+	using namespace SSE;
+
+	namespace {
+		void ScaleColorsSSE(Color *out, const Color *in, const float *weights, int count){
+			const bool stream = count * sizeof(Color) >= STREAM_STORE_BYTES && uintptr_t(out) % 16 == 0;
+			for (int i = 0; i < count; i++){
+				__m128 w = _mm_insert_ps(_mm_set1_ps(weights[i]), _mm_set_ss(1.f), 0x30);
+				__m128 c = _mm_div_ps(_mm_loadu_ps(&in[i].r), w);
+				if (stream)
+					_mm_stream_ps(&out[i].r, c);
+				else
+					_mm_storeu_ps(&out[i].r, c);
+			}
+			if (stream)
+				_mm_sfence();
+		}
+
+		inline __m128i QuantizeSSE(const float *in){
+			__m128 f = _mm_mul_ps(_mm_loadu_ps(in), _mm_set1_ps(255.f));
+			f = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(255.f));		// NaNs become 0
+			return _mm_cvttps_epi32(_mm_add_ps(f, _mm_set1_ps(0.5f)));
+		}
+
+		void QuantizeFloatsSSE(unsigned char *out, const float *in, int count){
+			int i = 0;
+			for (; i + 16 <= count; i += 16){
+				__m128i lo = _mm_packus_epi32(QuantizeSSE(in + i), QuantizeSSE(in + i + 4));
+				__m128i hi = _mm_packus_epi32(QuantizeSSE(in + i + 8), QuantizeSSE(in + i + 12));
+				_mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(lo, hi));
+			}
+			for (; i < count; i++)
+				out[i] = Math::Clamp(Math::Round(in[i] * 255), 0, 255);
+		}
+
+		void TransformPointsSSE(Vec3 *out, const Matrix4x4& m, const Vec3 *in, int count){
+			int i = 0;
+			for (; i + 4 <= count; i += 4){
+				const Vec3V4F p = LoadVec3x4(in + i);
+				Vec3V4F r;
+				for (int k = 0; k < 3; k++)
+					r[k] = p.x * V4Float(m[k][0]) + p.y * V4Float(m[k][1]) + p.z * V4Float(m[k][2]) + V4Float(m[k][3]);
+				StoreVec3x4(r, out + i);
+			}
+			for (; i < count; i++)
+				out[i] = Matrix4x4::TPoint(m, in[i]);
+		}
+
+		int IntersectTrianglesSSE(const Vec3 *vertices, const uint32_t *indices, const uint32_t *tri_ids, int count, const Ray& ray){
+			const Vec3V4F origin(V4Float(ray.origin.x), V4Float(ray.origin.y), V4Float(ray.origin.z));
+			const Vec3V4F dir(V4Float(ray.dir.x), V4Float(ray.dir.y), V4Float(ray.dir.z));
+			int hit = -1;
+			for (int i = 0; i < count; i += 4){
+				// triangle ids -> vertex indices -> vertices, lanes past the end read triangle 0 and are masked off
+				const V4Bool in_range = FirstLanes<V4Float>(count - i);
+				const V4Int tri = MaskedLoad<V4Int>(in_range, (const int32_t *)tri_ids + i) * 3;
+				Vec3V4F v[3];
+				for (int k = 0; k < 3; k++){
+					const V4Int vi = Gather<V4Int>((const int32_t *)indices, tri + k) * 3;
+					v[k] = Vec3V4F(Gather<V4Float>(&vertices->x, vi), Gather<V4Float>(&vertices->y, vi), Gather<V4Float>(&vertices->z, vi));
+				}
+				// Moller-Trumbore, as Mesh::Intersect()
+				const Vec3V4F e1 = v[1] - v[0];
+				const Vec3V4F e2 = v[2] - v[0];
+				const Vec3V4F P = Math::Cross(dir, e2);
+				const V4Float det = Math::Dot(e1, P);
+				V4Bool valid = in_range & (Abs(det) >= V4Float(Ray::EPSILON));
+				const V4Float inv_det = _mm_div_ps(V4Float::ONE, det);
+				const Vec3V4F T = origin - v[0];
+				const V4Float u = Math::Dot(T, P) * inv_det;
+				valid &= (u >= V4Float::ZERO) & (u <= V4Float::ONE);
+				const Vec3V4F Q = Math::Cross(T, e1);
+				const V4Float vv = Math::Dot(dir, Q) * inv_det;
+				valid &= (vv >= V4Float::ZERO) & (vv <= V4Float::ONE - u);
+				const V4Float t = Math::Dot(e2, Q) * inv_det;
+				valid &= (t >= V4Float(ray.t_min)) & (t <= V4Float(ray.t_max));
+				if (None(valid))
+					continue;
+				int lane = SelectMin(valid, t);
+				hit = i + lane;
+				ray.t_max = t[lane];
+			}
+			return hit;
+		}
+
+		KernelTable KernelsSSE(){
+			KernelTable table;
+			table.level = SimdLevel::SSE41;
+			table.ScaleColors = ScaleColorsSSE;
+			table.QuantizeFloats = QuantizeFloatsSSE;
+			table.TransformPoints = TransformPointsSSE;
+			table.IntersectTriangles = IntersectTrianglesSSE;
+			return table;
+		}
+	}
+
+	const KernelTable& Kernels(){
+		static const KernelTable& table = Kernels(CpuFeatures::Get().Level());
+		return table;
+	}
+
+	const KernelTable& Kernels(SimdLevel level){
+		static const KernelTable tables[] = { KernelsSSE(), KernelsAVX2(), KernelsAVX512() };
+		assert(CpuFeatures::Get().Supports(level));
+		return tables[int(level)];
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include "txbase/sys/cpu.h"
+
+namespace TX
+{
+	/// <summary>
+	/// Size from which kernels write their output past the caches, where it would only evict the inputs.
+	/// </summary>
+	const size_t STREAM_STORE_BYTES = 1 << 20;
+
+	/// <summary>
+	/// Hot loops compiled once per instruction set level, so that a single binary built for the
+	/// SSE 4.1 baseline still uses AVX2 or AVX-512 where the processor has them.
+	/// The levels produce the same results, up to the rounding of fused multiply-adds.
+	/// </summary>
+	struct KernelTable {
+		SimdLevel level;
+
+		/// <summary>
+		/// out[i] = in[i] / weights[i], the alpha channel is copied.
+		/// Outputs of STREAM_STORE_BYTES or more that are aligned to the vector size are written with non-temporal stores.
+		/// </summary>
+		void (*ScaleColors)(Color *out, const Color *in, const float *weights, int count);
+		/// <summary>
+		/// Converts [0, 1] floats to bytes, rounded to nearest and clamped.
+		/// </summary>
+		void (*QuantizeFloats)(unsigned char *out, const float *in, int count);
+		/// <summary>
+		/// out[i] = Matrix4x4::TPoint(m, in[i]), out may be the same array as in.
+		/// </summary>
+		void (*TransformPoints)(Vec3 *out, const Matrix4x4& m, const Vec3 *in, int count);
+		/// <summary>
+		/// Intersects the ray with the triangles tri_ids[0..count) of an indexed mesh, and returns
+		/// the position in tri_ids of the closest hit (shortening ray.t_max), or -1 if none is hit.
+		/// </summary>
+		int (*IntersectTriangles)(const Vec3 *vertices, const uint32_t *indices, const uint32_t *tri_ids, int count, const Ray& ray);
+	};
+
+	/// <summary>
+	/// Kernels of the highest level the processor supports, selected on first use.
+	/// </summary>
+	const KernelTable& Kernels();
+	/// <summary>
+	/// Kernels of the given level, which the processor must support (see CpuFeatures::Supports()).
+	/// </summary>
+	const KernelTable& Kernels(SimdLevel level);
+}
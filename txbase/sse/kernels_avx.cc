@@ -0,0 +1,236 @@
+#include "txbase/stdafx.h"
+#include "txbase/sse/kernels.h"
+#include "txbase/sse/bool.h"
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#else
+	#include <immintrin.h>
+#endif
+
+// The functions here are compiled for AVX2 / AVX-512 while the rest of the build stays at the baseline,
+// they're only called through the tables once CpuFeatures says the processor has the instructions.
+// Only raw intrinsics are used, since the inline SSE wrappers would be compiled for the baseline.
+#if defined(_MSC_VER)
+	#define TX_TARGET_AVX2
+	#define TX_TARGET_AVX512
+#else
+	#define TX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#define TX_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+namespace TX
+{
+	namespace {
+		//////////////////////////////////////// AVX2
+
+		TX_TARGET_AVX2 void ScaleColorsAVX2(Color *out, const Color *in, const float *weights, int count){
+			const __m256 one = _mm256_set1_ps(1.f);
+			const bool stream = count * sizeof(Color) >= STREAM_STORE_BYTES && uintptr_t(out) % 32 == 0;
+			int i = 0;
+			for (; i + 8 <= count; i += 8){
+				const __m256 w8 = _mm256_loadu_ps(weights + i);
+				for (int k = 0; k < 4; k++){
+					// weights of two colors, with 1 for the alpha channels
+					__m256 w = _mm256_permutevar8x32_ps(w8, _mm256_setr_epi32(2 * k, 2 * k, 2 * k, 2 * k, 2 * k + 1, 2 * k + 1, 2 * k + 1, 2 * k + 1));
+					w = _mm256_blend_ps(w, one, 0x88);
+					float *dst = &out[i + 2 * k].r;
+					__m256 c = _mm256_div_ps(_mm256_loadu_ps(&in[i + 2 * k].r), w);
+					if (stream)
+						_mm256_stream_ps(dst, c);
+					else
+						_mm256_storeu_ps(dst, c);
+				}
+			}
+			for (; i < count; i++){
+				__m128 w = _mm_blend_ps(_mm_set1_ps(weights[i]), _mm_set1_ps(1.f), 0x8);
+				_mm_storeu_ps(&out[i].r, _mm_div_ps(_mm_loadu_ps(&in[i].r), w));
+			}
+			if (stream)
+				_mm_sfence();
+		}
+
+		TX_TARGET_AVX2 inline __m256i QuantizeAVX2(const float *in){
+			__m256 f = _mm256_mul_ps(_mm256_loadu_ps(in), _mm256_set1_ps(255.f));
+			f = _mm256_min_ps(_mm256_max_ps(f, _mm256_setzero_ps()), _mm256_set1_ps(255.f));		// NaNs become 0
+			return _mm256_cvttps_epi32(_mm256_add_ps(f, _mm256_set1_ps(0.5f)));
+		}
+
+		TX_TARGET_AVX2 void QuantizeFloatsAVX2(unsigned char *out, const float *in, int count){
+			int i = 0;
+			for (; i + 32 <= count; i += 32){
+				// the packs work within 128 bit halves, the permute puts the groups of four back in order
+				__m256i ab = _mm256_packus_epi32(QuantizeAVX2(in + i), QuantizeAVX2(in + i + 8));
+				__m256i cd = _mm256_packus_epi32(QuantizeAVX2(in + i + 16), QuantizeAVX2(in + i + 24));
+				__m256i bytes = _mm256_packus_epi16(ab, cd);
+				bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+				_mm256_storeu_si256((__m256i *)(out + i), bytes);
+			}
+			for (; i < count; i++)
+				out[i] = Math::Clamp(Math::Round(in[i] * 255), 0, 255);
+		}
+
+		TX_TARGET_AVX2 void TransformPointsAVX2(Vec3 *out, const Matrix4x4& m, const Vec3 *in, int count){
+			int i = 0;
+			for (; i + 8 <= count; i += 8){
+				// eight points to x, y, z vectors, two groups of four as the 128 bit version
+				const float *src = &in[i].x;
+				__m256 m03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)), _mm_loadu_ps(src + 12), 1);
+				__m256 m14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 16), 1);
+				__m256 m25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 20), 1);
+				__m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+				__m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+				__m256 x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+				__m256 y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+				__m256 z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+				__m256 r[3];
+				for (int k = 0; k < 3; k++){
+					r[k] = _mm256_fmadd_ps(z, _mm256_set1_ps(m[k][2]), _mm256_set1_ps(m[k][3]));
+					r[k] = _mm256_fmadd_ps(y, _mm256_set1_ps(m[k][1]), r[k]);
+					r[k] = _mm256_fmadd_ps(x, _mm256_set1_ps(m[k][0]), r[k]);
+				}
+				__m256 rxy = _mm256_shuffle_ps(r[0], r[1], _MM_SHUFFLE(2, 0, 2, 0));
+				__m256 ryz = _mm256_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 1, 3, 1));
+				__m256 rzx = _mm256_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 1, 2, 0));
+				m03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+				m14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+				m25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+				float *dst = &out[i].x;
+				_mm_storeu_ps(dst, _mm256_castps256_ps128(m03));
+				_mm_storeu_ps(dst + 4, _mm256_castps256_ps128(m14));
+				_mm_storeu_ps(dst + 8, _mm256_castps256_ps128(m25));
+				_mm_storeu_ps(dst + 12, _mm256_extractf128_ps(m03, 1));
+				_mm_storeu_ps(dst + 16, _mm256_extractf128_ps(m14, 1));
+				_mm_storeu_ps(dst + 20, _mm256_extractf128_ps(m25, 1));
+			}
+			for (; i < count; i++)
+				out[i] = Matrix4x4::TPoint(m, in[i]);
+		}
+
+		struct Vec3x8 { __m256 x, y, z; };
+
+		TX_TARGET_AVX2 inline Vec3x8 Sub(const Vec3x8& a, const Vec3x8& b){
+			return{ _mm256_sub_ps(a.x, b.x), _mm256_sub_ps(a.y, b.y), _mm256_sub_ps(a.z, b.z) };
+		}
+		TX_TARGET_AVX2 inline Vec3x8 Cross(const Vec3x8& a, const Vec3x8& b){
+			return{
+				_mm256_sub_ps(_mm256_mul_ps(a.y, b.z), _mm256_mul_ps(a.z, b.y)),
+				_mm256_sub_ps(_mm256_mul_ps(a.z, b.x), _mm256_mul_ps(a.x, b.z)),
+				_mm256_sub_ps(_mm256_mul_ps(a.x, b.y), _mm256_mul_ps(a.y, b.x)) };
+		}
+		TX_TARGET_AVX2 inline __m256 Dot(const Vec3x8& a, const Vec3x8& b){
+			return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a.x, b.x), _mm256_mul_ps(a.y, b.y)), _mm256_mul_ps(a.z, b.z));
+		}
+		TX_TARGET_AVX2 inline __m256 InBounds(__m256 v, __m256 min, __m256 max){
+			return _mm256_and_ps(_mm256_cmp_ps(v, min, _CMP_GE_OQ), _mm256_cmp_ps(v, max, _CMP_LE_OQ));
+		}
+
+		TX_TARGET_AVX2 int IntersectTrianglesAVX2(const Vec3 *vertices, const uint32_t *indices, const uint32_t *tri_ids, int count, const Ray& ray){
+			const Vec3x8 origin = { _mm256_set1_ps(ray.origin.x), _mm256_set1_ps(ray.origin.y), _mm256_set1_ps(ray.origin.z) };
+			const Vec3x8 dir = { _mm256_set1_ps(ray.dir.x), _mm256_set1_ps(ray.dir.y), _mm256_set1_ps(ray.dir.z) };
+			const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f);
+			const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), three = _mm256_set1_epi32(3);
+			int hit = -1;
+			for (int i = 0; i < count; i += 8){
+				// triangle ids -> vertex indices -> vertices, lanes past the end read triangle 0 and are masked off
+				const __m256i in_range = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), lanes);
+				const __m256i tri = _mm256_mullo_epi32(_mm256_maskload_epi32((const int *)tri_ids + i, in_range), three);
+				Vec3x8 v[3];
+				for (int k = 0; k < 3; k++){
+					const __m256i vi = _mm256_mullo_epi32(_mm256_i32gather_epi32((const int *)indices, _mm256_add_epi32(tri, _mm256_set1_epi32(k)), 4), three);
+					v[k] = {
+						_mm256_i32gather_ps(&vertices->x, vi, 4),
+						_mm256_i32gather_ps(&vertices->y, vi, 4),
+						_mm256_i32gather_ps(&vertices->z, vi, 4) };
+				}
+				// Moller-Trumbore, as Mesh::Intersect()
+				const Vec3x8 e1 = Sub(v[1], v[0]);
+				const Vec3x8 e2 = Sub(v[2], v[0]);
+				const Vec3x8 P = Cross(dir, e2);
+				const __m256 det = Dot(e1, P);
+				const __m256 abs_det = _mm256_andnot_ps(_mm256_set1_ps(-0.f), det);
+				__m256 valid = _mm256_and_ps(_mm256_castsi256_ps(in_range), _mm256_cmp_ps(abs_det, _mm256_set1_ps(Ray::EPSILON), _CMP_GE_OQ));
+				const __m256 inv_det = _mm256_div_ps(one, det);
+				const Vec3x8 T = Sub(origin, v[0]);
+				const __m256 u = _mm256_mul_ps(Dot(T, P), inv_det);
+				valid = _mm256_and_ps(valid, InBounds(u, zero, one));
+				const Vec3x8 Q = Cross(T, e1);
+				valid = _mm256_and_ps(valid, InBounds(_mm256_mul_ps(Dot(dir, Q), inv_det), zero, _mm256_sub_ps(one, u)));
+				const __m256 t = _mm256_mul_ps(Dot(e2, Q), inv_det);
+				valid = _mm256_and_ps(valid, InBounds(t, _mm256_set1_ps(ray.t_min), _mm256_set1_ps(ray.t_max)));
+				if (_mm256_testz_ps(valid, valid))
+					continue;
+				// closest of the valid lanes
+				__m256 f = _mm256_blendv_ps(_mm256_set1_ps(Math::INF), t, valid);
+				__m256 min = _mm256_min_ps(f, _mm256_permute2f128_ps(f, f, 1));
+				min = _mm256_min_ps(min, _mm256_permute_ps(min, _MM_SHUFFLE(1, 0, 3, 2)));
+				min = _mm256_min_ps(min, _mm256_permute_ps(min, _MM_SHUFFLE(2, 3, 0, 1)));
+				int lane = __bsf(_mm256_movemask_ps(_mm256_and_ps(valid, _mm256_cmp_ps(f, min, _CMP_EQ_OQ))));
+				hit = i + lane;
+				ray.t_max = _mm256_cvtss_f32(min);
+			}
+			return hit;
+		}
+
+		//////////////////////////////////////// AVX-512
+
+		// The unmasked forms of some intrinsics pass GCC an undefined source, which -Wmaybe-uninitialized
+		// reports. The zero-masked forms with every lane set compile to the same instructions.
+		const __mmask16 ALL_LANES = 0xFFFF;
+
+		TX_TARGET_AVX512 void ScaleColorsAVX512(Color *out, const Color *in, const float *weights, int count){
+			const __m512 one = _mm512_set1_ps(1.f);
+			const __m512i spread = _mm512_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+			const bool stream = count * sizeof(Color) >= STREAM_STORE_BYTES && uintptr_t(out) % 64 == 0;
+			int i = 0;
+			for (; i + 16 <= count; i += 16){
+				const __m512 w16 = _mm512_loadu_ps(weights + i);
+				for (int k = 0; k < 4; k++){
+					// weights of four colors, with 1 for the alpha channels
+					__m512 w = _mm512_maskz_permutexvar_ps(ALL_LANES, _mm512_add_epi32(spread, _mm512_set1_epi32(4 * k)), w16);
+					w = _mm512_mask_blend_ps(0x8888, w, one);
+					float *dst = &out[i + 4 * k].r;
+					__m512 c = _mm512_div_ps(_mm512_loadu_ps(&in[i + 4 * k].r), w);
+					if (stream)
+						_mm512_stream_ps(dst, c);
+					else
+						_mm512_storeu_ps(dst, c);
+				}
+			}
+			if (stream)
+				_mm_sfence();
+			ScaleColorsAVX2(out + i, in + i, weights + i, count - i);
+		}
+
+		TX_TARGET_AVX512 void QuantizeFloatsAVX512(unsigned char *out, const float *in, int count){
+			int i = 0;
+			for (; i + 16 <= count; i += 16){
+				__m512 f = _mm512_mul_ps(_mm512_loadu_ps(in + i), _mm512_set1_ps(255.f));
+				f = _mm512_maskz_min_ps(ALL_LANES, _mm512_maskz_max_ps(ALL_LANES, f, _mm512_setzero_ps()), _mm512_set1_ps(255.f));		// NaNs become 0
+				__m512i n = _mm512_maskz_cvttps_epi32(ALL_LANES, _mm512_add_ps(f, _mm512_set1_ps(0.5f)));
+				_mm_storeu_si128((__m128i *)(out + i), _mm512_maskz_cvtusepi32_epi8(ALL_LANES, n));
+			}
+			for (; i < count; i++)
+				out[i] = Math::Clamp(Math::Round(in[i] * 255), 0, 255);
+		}
+	}
+
+	KernelTable KernelsAVX2(){
+		KernelTable table;
+		table.level = SimdLevel::AVX2;
+		table.ScaleColors = ScaleColorsAVX2;
+		table.QuantizeFloats = QuantizeFloatsAVX2;
+		table.TransformPoints = TransformPointsAVX2;
+		table.IntersectTriangles = IntersectTrianglesAVX2;
+		return table;
+	}
+
+	KernelTable KernelsAVX512(){
+		// point transforms and triangle tests are bound by the shuffles and gathers, the 8 wide versions are kept
+		KernelTable table = KernelsAVX2();
+		table.level = SimdLevel::AVX512;
+		table.ScaleColors = ScaleColorsAVX512;
+		table.QuantizeFloats = QuantizeFloatsAVX512;
+		return table;
+	}
+}
@@ -0,0 +1,361 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include "txbase/sse/sse.h"
+
+namespace TX {
+	namespace SSE {
+		/// <summary>
+		/// Lanes of a packet kept in an array, for the widths without a native type.
+		/// Has the operators of V4Float, V4Int and V4Bool, each applied lane by lane.
+		/// </summary>
+		template<typename T, int W>
+		struct PacketArray {
+		public:
+			T v[W];
+		public:
+			inline PacketArray() : v() {}
+			inline PacketArray(const T& s) { for (int i = 0; i < W; i++) v[i] = s; }
+			inline explicit PacketArray(const T *arr) { for (int i = 0; i < W; i++) v[i] = arr[i]; }
+
+			inline const T& operator [] (const size_t i) const { return v[i]; }
+			inline		 T& operator [] (const size_t i)       { return v[i]; }
+
+			inline const PacketArray operator + () const { return *this; }
+			inline const PacketArray operator - () const { return Map([](const T& a){ return T(-a); }); }
+			inline const PacketArray operator ! () const { return Map([](const T& a){ return T(!a); }); }
+
+			inline const PacketArray operator + (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a + b); }); }
+			inline const PacketArray operator - (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a - b); }); }
+			inline const PacketArray operator * (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a * b); }); }
+			inline const PacketArray operator / (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a / b); }); }
+			inline const PacketArray operator & (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a & b); }); }
+			inline const PacketArray operator | (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a | b); }); }
+			inline const PacketArray operator ^ (const PacketArray& ot) const { return Map(ot, [](const T& a, const T& b){ return T(a ^ b); }); }
+			inline PacketArray& operator += (const PacketArray& ot) { return *this = *this + ot; }
+			inline PacketArray& operator -= (const PacketArray& ot) { return *this = *this - ot; }
+			inline PacketArray& operator *= (const PacketArray& ot) { return *this = *this * ot; }
+			inline PacketArray& operator /= (const PacketArray& ot) { return *this = *this / ot; }
+			inline PacketArray& operator &= (const PacketArray& ot) { return *this = *this & ot; }
+			inline PacketArray& operator |= (const PacketArray& ot) { return *this = *this | ot; }
+			inline PacketArray& operator ^= (const PacketArray& ot) { return *this = *this ^ ot; }
+
+			inline const PacketArray<bool, W> operator == (const PacketArray& ot) const { return Compare(ot, [](const T& a, const T& b){ return a == b; }); }
+			inline const PacketArray<bool, W> operator != (const PacketArray& ot) const { return Compare(ot, [](const T& a, const T& b){ return a != b; }); }
+			inline const PacketArray<bool, W> operator < (const PacketArray& ot) const { return Compare(ot, [](const T& a, const T& b){ return a < b; }); }
+			inline const PacketArray<bool, W> operator > (const PacketArray& ot) const { return Compare(ot, [](const T& a, const T& b){ return a > b; }); }
+			inline const PacketArray<bool, W> operator <= (const PacketArray& ot) const { return Compare(ot, [](const T& a, const T& b){ return a <= b; }); }
+			inline const PacketArray<bool, W> operator >= (const PacketArray& ot) const { return Compare(ot, [](const T& a, const T& b){ return a >= b; }); }
+
+			template<typename F>
+			inline const PacketArray Map(F f) const {
+				PacketArray r;
+				for (int i = 0; i < W; i++) r.v[i] = f(v[i]);
+				return r;
+			}
+			template<typename F>
+			inline const PacketArray Map(const PacketArray& ot, F f) const {
+				PacketArray r;
+				for (int i = 0; i < W; i++) r.v[i] = f(v[i], ot.v[i]);
+				return r;
+			}
+		private:
+			template<typename F>
+			inline const PacketArray<bool, W> Compare(const PacketArray& ot, F f) const {
+				PacketArray<bool, W> r;
+				for (int i = 0; i < W; i++) r.v[i] = f(v[i], ot.v[i]);
+				return r;
+			}
+		};
+		template<typename T, int W>
+		inline PacketArray<T, W> operator * (const T& s, const PacketArray<T, W>& v) { return PacketArray<T, W>(s) * v; }
+		template<typename T, int W>
+		inline std::ostream& operator << (std::ostream& os, const PacketArray<T, W>& v) {
+			os << "(" << v.v[0];
+			for (int i = 1; i < W; i++)
+				os << ", " << v.v[i];
+			return os << ")";
+		}
+
+		template<typename T, int W>
+		inline const PacketArray<T, W> Abs(const PacketArray<T, W>& v) { return v.Map([](const T& a){ return a < T(0) ? T(-a) : a; }); }
+		template<typename T, int W>
+		inline const PacketArray<T, W> Min(const PacketArray<T, W>& a, const PacketArray<T, W>& b) { return a.Map(b, [](const T& x, const T& y){ return y < x ? y : x; }); }
+		template<typename T, int W>
+		inline const PacketArray<T, W> Max(const PacketArray<T, W>& a, const PacketArray<T, W>& b) { return a.Map(b, [](const T& x, const T& y){ return x < y ? y : x; }); }
+		template<int W>
+		inline const PacketArray<float, W> Floor(const PacketArray<float, W>& v) { return v.Map([](float a){ return std::floor(a); }); }
+		template<int W>
+		inline const PacketArray<float, W> Ceil(const PacketArray<float, W>& v) { return v.Map([](float a){ return std::ceil(a); }); }
+		template<int W>
+		inline const PacketArray<float, W> MulAdd(const PacketArray<float, W>& a, const PacketArray<float, W>& b, const PacketArray<float, W>& c) { return a * b + c; }
+		template<int W>
+		inline const PacketArray<float, W> MulSub(const PacketArray<float, W>& a, const PacketArray<float, W>& b, const PacketArray<float, W>& c) { return a * b - c; }
+		template<int W>
+		inline const PacketArray<float, W> NegMulAdd(const PacketArray<float, W>& a, const PacketArray<float, W>& b, const PacketArray<float, W>& c) { return c - a * b; }
+		template<int W>
+		inline const PacketArray<float, W> Sqrt(const PacketArray<float, W>& v) { return v.Map([](float a){ return std::sqrt(a); }); }
+		template<int W>
+		inline const PacketArray<float, W> Rsqrt(const PacketArray<float, W>& v) { return v.Map([](float a){ return 1.f / std::sqrt(a); }); }
+		template<int W>
+		inline const PacketArray<float, W> Rcp(const PacketArray<float, W>& v) { return v.Map([](float a){ return 1.f / a; }); }
+		template<int W>
+		inline const PacketArray<float, W> SqrtFast(const PacketArray<float, W>& v) { return Sqrt(v); }
+		template<int W>
+		inline const PacketArray<float, W> RsqrtFast(const PacketArray<float, W>& v) { return Rsqrt(v); }
+		template<int W>
+		inline const PacketArray<float, W> RcpFast(const PacketArray<float, W>& v) { return Rcp(v); }
+		template<typename T, int W>
+		inline const PacketArray<T, W> Select(const PacketArray<bool, W>& maska, const PacketArray<T, W>& a, const PacketArray<T, W>& b) {
+			PacketArray<T, W> r;
+			for (int i = 0; i < W; i++) r.v[i] = maska.v[i] ? a.v[i] : b.v[i];
+			return r;
+		}
+		template<int W>
+		inline bool All(const PacketArray<bool, W>& a) { for (int i = 0; i < W; i++) if (!a.v[i]) return false; return true; }
+		template<int W>
+		inline bool Any(const PacketArray<bool, W>& a) { for (int i = 0; i < W; i++) if (a.v[i]) return true; return false; }
+		template<int W>
+		inline bool None(const PacketArray<bool, W>& a) { return !Any(a); }
+		template<typename T, int W>
+		inline const T ReduceAdd(const PacketArray<T, W>& v) { T r = v.v[0]; for (int i = 1; i < W; i++) r = r + v.v[i]; return r; }
+		template<typename T, int W>
+		inline const T ReduceMin(const PacketArray<T, W>& v) { T r = v.v[0]; for (int i = 1; i < W; i++) r = v.v[i] < r ? v.v[i] : r; return r; }
+		template<typename T, int W>
+		inline const T ReduceMax(const PacketArray<T, W>& v) { T r = v.v[0]; for (int i = 1; i < W; i++) r = r < v.v[i] ? v.v[i] : r; return r; }
+		/// <summary>
+		/// Lane of the smallest valid value, -1 if no lane is valid, like the native packets.
+		/// </summary>
+		template<typename T, int W>
+		inline int SelectMin(const PacketArray<bool, W>& valid, const PacketArray<T, W>& v) {
+			int r = -1;
+			for (int i = 0; i < W; i++) if (valid.v[i] && (r < 0 || v.v[i] < v.v[r])) r = i;
+			return r;
+		}
+		template<typename T, int W>
+		inline int SelectMin(const PacketArray<T, W>& v) { return SelectMin(PacketArray<bool, W>(true), v); }
+
+		/// <summary>
+		/// Scalars are packets of one lane, these let generic code call the packet functions on them too.
+		/// </summary>
+		inline float Abs(float v) { return std::abs(v); }
+		inline float Min(float a, float b) { return b < a ? b : a; }
+		inline float Max(float a, float b) { return a < b ? b : a; }
+		inline float Floor(float v) { return std::floor(v); }
+		inline float Ceil(float v) { return std::ceil(v); }
+		inline float MulAdd(float a, float b, float c) { return a * b + c; }
+		inline float MulSub(float a, float b, float c) { return a * b - c; }
+		inline float NegMulAdd(float a, float b, float c) { return c - a * b; }
+		inline float Sqrt(float v) { return std::sqrt(v); }
+		inline float Rsqrt(float v) { return 1.f / std::sqrt(v); }
+		inline float Rcp(float v) { return 1.f / v; }
+		inline float SqrtFast(float v) { return Sqrt(v); }
+		inline float RsqrtFast(float v) { return Rsqrt(v); }
+		inline float RcpFast(float v) { return Rcp(v); }
+		inline float Select(bool maska, float a, float b) { return maska ? a : b; }
+		inline int32_t Select(bool maska, int32_t a, int32_t b) { return maska ? a : b; }
+		inline bool All(bool a) { return a; }
+		inline bool Any(bool a) { return a; }
+		inline bool None(bool a) { return !a; }
+		inline float ReduceAdd(float v) { return v; }
+		inline float ReduceMin(float v) { return v; }
+		inline float ReduceMax(float v) { return v; }
+		inline int SelectMin(float) { return 0; }
+		inline int SelectMin(bool valid, float) { return valid ? 0 : -1; }
+
+		/// <summary>
+		/// Packet of W lanes of T (float, int32_t or bool for masks): the scalar itself for one lane,
+		/// the SSE, AVX or AVX-512 type for the widths the build has, otherwise a PacketArray.
+		/// Like the V4 types, packets can be the components of Vec, e.g. Vec<3, Packet<float, 8>>.
+		/// </summary>
+		template<typename T, int W> struct PacketType { typedef PacketArray<T, W> type; };
+		template<typename T, int W> using Packet = typename PacketType<T, W>::type;
+
+		template<> struct PacketType<float, 1> { typedef float type; };
+		template<> struct PacketType<int32_t, 1> { typedef int32_t type; };
+		template<> struct PacketType<bool, 1> { typedef bool type; };
+		template<> struct PacketType<float, 4> { typedef V4Float type; };
+		template<> struct PacketType<int32_t, 4> { typedef V4Int type; };
+		template<> struct PacketType<bool, 4> { typedef V4Bool type; };
+#ifdef __AVX2__
+		template<> struct PacketType<float, 8> { typedef V8Float type; };
+		template<> struct PacketType<int32_t, 8> { typedef V8Int type; };
+		template<> struct PacketType<bool, 8> { typedef V8Bool type; };
+#endif
+#ifdef __AVX512F__
+		template<> struct PacketType<float, 16> { typedef V16Float type; };
+		template<> struct PacketType<int32_t, 16> { typedef V16Int type; };
+		template<> struct PacketType<bool, 16> { typedef V16Bool type; };
+#endif
+
+		/// <summary>
+		/// Widest native packet of the build.
+		/// </summary>
+#if defined(__AVX512F__)
+		const int PACKET_WIDTH = 16;
+#elif defined(__AVX2__)
+		const int PACKET_WIDTH = 8;
+#else
+		const int PACKET_WIDTH = 4;
+#endif
+		template<typename T> using NativePacket = Packet<T, PACKET_WIDTH>;
+
+		/// <summary>
+		/// Lane type, width and mask type of a packet, and the loads and stores of its lanes:
+		/// unaligned, aligned to the packet size, non-temporal (Stream, bypassing the caches, follow with StreamFence()),
+		/// gathered by index, and masked (lanes off are zero on loads, and their memory is not touched, so masks can cover array tails).
+		/// The gathers and masked operations are native with AVX2 / AVX-512, emulated lane by lane otherwise.
+		/// </summary>
+		template<typename P> struct PacketTraits;
+
+		template<typename T, int W, typename P>
+		struct PacketTraitsBase {
+			typedef T Scalar;
+			typedef Packet<bool, W> Mask;
+			typedef Packet<int32_t, W> Index;
+			static const int WIDTH = W;
+			static inline P Load(const T *p) { return P(p); }
+			static inline void Store(const P& v, T *p) { for (int i = 0; i < W; i++) p[i] = v[i]; }
+			static inline P LoadAligned(const T *p) { return PacketTraits<P>::Load(p); }
+			static inline void StoreAligned(const P& v, T *p) { PacketTraits<P>::Store(v, p); }
+			static inline void Stream(const P& v, T *p) { PacketTraits<P>::StoreAligned(v, p); }
+			static inline P Gather(const T *base, const Index& idx) {
+				P r;
+				for (int i = 0; i < W; i++) r[i] = base[idx[i]];
+				return r;
+			}
+			static inline P MaskedLoad(const Mask& mask, const T *p) {
+				P r(T(0));
+				for (int i = 0; i < W; i++) if (mask[i]) r[i] = p[i];
+				return r;
+			}
+			static inline void MaskedStore(const Mask& mask, const P& v, T *p) { for (int i = 0; i < W; i++) if (mask[i]) p[i] = v[i]; }
+			/// <summary>
+			/// Mask of the lanes below n.
+			/// </summary>
+			static inline Mask FirstLanes(int n) {
+				int32_t lanes[W];
+				for (int i = 0; i < W; i++) lanes[i] = i;
+				return PacketTraits<Index>::Load(lanes) < n;
+			}
+		};
+		template<> struct PacketTraits<float> : PacketTraitsBase<float, 1, float> {
+			static inline float Load(const float *p) { return *p; }
+			static inline void Store(float v, float *p) { *p = v; }
+			static inline float Gather(const float *base, int32_t idx) { return base[idx]; }
+			static inline float MaskedLoad(bool mask, const float *p) { return mask ? *p : 0.f; }
+			static inline void MaskedStore(bool mask, float v, float *p) { if (mask) *p = v; }
+		};
+		template<> struct PacketTraits<int32_t> : PacketTraitsBase<int32_t, 1, int32_t> {
+			static inline int32_t Load(const int32_t *p) { return *p; }
+			static inline void Store(int32_t v, int32_t *p) { *p = v; }
+			static inline int32_t Gather(const int32_t *base, int32_t idx) { return base[idx]; }
+			static inline int32_t MaskedLoad(bool mask, const int32_t *p) { return mask ? *p : 0; }
+			static inline void MaskedStore(bool mask, int32_t v, int32_t *p) { if (mask) *p = v; }
+		};
+		template<> struct PacketTraits<V4Float> : PacketTraitsBase<float, 4, V4Float> {
+			static inline void Store(const V4Float& v, float *p) { _mm_storeu_ps(p, v); }
+			static inline V4Float LoadAligned(const float *p) { return _mm_load_ps(p); }
+			static inline void StoreAligned(const V4Float& v, float *p) { _mm_store_ps(p, v); }
+			static inline void Stream(const V4Float& v, float *p) { _mm_stream_ps(p, v); }
+			static inline V4Float Gather(const float *base, const V4Int& idx) {
+#ifdef __AVX2__
+				return _mm_i32gather_ps(base, idx, 4);
+#else
+				return _mm_setr_ps(base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]);
+#endif
+			}
+#ifdef __AVX__
+			static inline V4Float MaskedLoad(const V4Bool& mask, const float *p) { return _mm_maskload_ps(p, _mm_castps_si128(mask)); }
+			static inline void MaskedStore(const V4Bool& mask, const V4Float& v, float *p) { _mm_maskstore_ps(p, _mm_castps_si128(mask), v); }
+#endif
+		};
+		template<> struct PacketTraits<V4Int> : PacketTraitsBase<int32_t, 4, V4Int> {
+			static inline V4Int Load(const int32_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+			static inline void Store(const V4Int& v, int32_t *p) { _mm_storeu_si128((__m128i *)p, v); }
+			static inline V4Int LoadAligned(const int32_t *p) { return _mm_load_si128((const __m128i *)p); }
+			static inline void StoreAligned(const V4Int& v, int32_t *p) { _mm_store_si128((__m128i *)p, v); }
+			static inline void Stream(const V4Int& v, int32_t *p) { _mm_stream_si128((__m128i *)p, v); }
+			static inline V4Int Gather(const int32_t *base, const V4Int& idx) {
+#ifdef __AVX2__
+				return _mm_i32gather_epi32((const int *)base, idx, 4);
+#else
+				return _mm_setr_epi32(base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]);
+#endif
+			}
+#ifdef __AVX2__
+			static inline V4Int MaskedLoad(const V4Bool& mask, const int32_t *p) { return _mm_maskload_epi32((const int *)p, _mm_castps_si128(mask)); }
+			static inline void MaskedStore(const V4Bool& mask, const V4Int& v, int32_t *p) { _mm_maskstore_epi32((int *)p, _mm_castps_si128(mask), v); }
+#endif
+		};
+#ifdef __AVX2__
+		template<> struct PacketTraits<V8Float> : PacketTraitsBase<float, 8, V8Float> {
+			static inline void Store(const V8Float& v, float *p) { _mm256_storeu_ps(p, v); }
+			static inline V8Float LoadAligned(const float *p) { return _mm256_load_ps(p); }
+			static inline void StoreAligned(const V8Float& v, float *p) { _mm256_store_ps(p, v); }
+			static inline void Stream(const V8Float& v, float *p) { _mm256_stream_ps(p, v); }
+			static inline V8Float Gather(const float *base, const V8Int& idx) { return _mm256_i32gather_ps(base, idx, 4); }
+			static inline V8Float MaskedLoad(const V8Bool& mask, const float *p) { return _mm256_maskload_ps(p, _mm256_castps_si256(mask)); }
+			static inline void MaskedStore(const V8Bool& mask, const V8Float& v, float *p) { _mm256_maskstore_ps(p, _mm256_castps_si256(mask), v); }
+		};
+		template<> struct PacketTraits<V8Int> : PacketTraitsBase<int32_t, 8, V8Int> {
+			static inline void Store(const V8Int& v, int32_t *p) { _mm256_storeu_si256((__m256i *)p, v); }
+			static inline V8Int LoadAligned(const int32_t *p) { return _mm256_load_si256((const __m256i *)p); }
+			static inline void StoreAligned(const V8Int& v, int32_t *p) { _mm256_store_si256((__m256i *)p, v); }
+			static inline void Stream(const V8Int& v, int32_t *p) { _mm256_stream_si256((__m256i *)p, v); }
+			static inline V8Int Gather(const int32_t *base, const V8Int& idx) { return _mm256_i32gather_epi32((const int *)base, idx, 4); }
+			static inline V8Int MaskedLoad(const V8Bool& mask, const int32_t *p) { return _mm256_maskload_epi32((const int *)p, _mm256_castps_si256(mask)); }
+			static inline void MaskedStore(const V8Bool& mask, const V8Int& v, int32_t *p) { _mm256_maskstore_epi32((int *)p, _mm256_castps_si256(mask), v); }
+		};
+#endif
+#ifdef __AVX512F__
+		template<> struct PacketTraits<V16Float> : PacketTraitsBase<float, 16, V16Float> {
+			static inline void Store(const V16Float& v, float *p) { _mm512_storeu_ps(p, v); }
+			static inline V16Float LoadAligned(const float *p) { return _mm512_load_ps(p); }
+			static inline void StoreAligned(const V16Float& v, float *p) { _mm512_store_ps(p, v); }
+			static inline void Stream(const V16Float& v, float *p) { _mm512_stream_ps(p, v); }
+			static inline V16Float Gather(const float *base, const V16Int& idx) { return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx, base, 4); }
+			static inline V16Float MaskedLoad(const V16Bool& mask, const float *p) { return _mm512_maskz_loadu_ps(mask, p); }
+			static inline void MaskedStore(const V16Bool& mask, const V16Float& v, float *p) { _mm512_mask_storeu_ps(p, mask, v); }
+		};
+		template<> struct PacketTraits<V16Int> : PacketTraitsBase<int32_t, 16, V16Int> {
+			static inline void Store(const V16Int& v, int32_t *p) { _mm512_storeu_si512(p, v); }
+			static inline V16Int LoadAligned(const int32_t *p) { return _mm512_load_si512(p); }
+			static inline void StoreAligned(const V16Int& v, int32_t *p) { _mm512_store_si512(p, v); }
+			static inline void Stream(const V16Int& v, int32_t *p) { _mm512_stream_si512((__m512i *)p, v); }
+			static inline V16Int Gather(const int32_t *base, const V16Int& idx) { return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, idx, base, 4); }
+			static inline V16Int MaskedLoad(const V16Bool& mask, const int32_t *p) { return _mm512_maskz_loadu_epi32(mask, p); }
+			static inline void MaskedStore(const V16Bool& mask, const V16Int& v, int32_t *p) { _mm512_mask_storeu_epi32(p, mask, v); }
+		};
+#endif
+		template<typename T, int W> struct PacketTraits<PacketArray<T, W>> : PacketTraitsBase<T, W, PacketArray<T, W>> {};
+
+		template<typename P>
+		inline P Load(const typename PacketTraits<P>::Scalar *p) { return PacketTraits<P>::Load(p); }
+		template<typename P>
+		inline void Store(const P& v, typename PacketTraits<P>::Scalar *p) { PacketTraits<P>::Store(v, p); }
+		template<typename P>
+		inline P LoadAligned(const typename PacketTraits<P>::Scalar *p) { return PacketTraits<P>::LoadAligned(p); }
+		template<typename P>
+		inline void StoreAligned(const P& v, typename PacketTraits<P>::Scalar *p) { PacketTraits<P>::StoreAligned(v, p); }
+		template<typename P>
+		inline void Stream(const P& v, typename PacketTraits<P>::Scalar *p) { PacketTraits<P>::Stream(v, p); }
+		/// <summary>
+		/// Orders the non-temporal stores before the stores that follow, e.g. before handing the buffer to another thread.
+		/// </summary>
+		inline void StreamFence() { _mm_sfence(); }
+		template<typename P>
+		inline P Gather(const typename PacketTraits<P>::Scalar *base, const typename PacketTraits<P>::Index& idx) { return PacketTraits<P>::Gather(base, idx); }
+		template<typename P>
+		inline P MaskedLoad(const typename PacketTraits<P>::Mask& mask, const typename PacketTraits<P>::Scalar *p) { return PacketTraits<P>::MaskedLoad(mask, p); }
+		template<typename P>
+		inline void MaskedStore(const typename PacketTraits<P>::Mask& mask, const P& v, typename PacketTraits<P>::Scalar *p) { PacketTraits<P>::MaskedStore(mask, v, p); }
+		template<typename P>
+		inline typename PacketTraits<P>::Mask FirstLanes(int n) { return PacketTraits<P>::FirstLanes(n); }
+
+		template<typename P>
+		inline typename PacketTraits<P>::Scalar Lane(const P& v, int i) { return v[i]; }
+		inline float Lane(float v, int) { return v; }
+		inline int32_t Lane(int32_t v, int) { return v; }
+	}
+}
@@ -0,0 +1,64 @@
+#include "txbase/stdafx.h"
+#include "txbase/sse/quaternion.h"
+#include "txbase/sse/soa.h"
+
+namespace TX {
+	namespace SSE {
+		namespace {
+			typedef NativePacket<float> P;
+			typedef QuaternionPacket<P> Q;
+			const int W = Q::WIDTH;
+
+			// calls f(first, lanes) for each packet of [0, count)
+			template<typename F>
+			inline void ForEachLanes(size_t count, F f) {
+				for (size_t i = 0; i < count; i += W)
+					f(i, int(std::min(count - i, size_t(W))));
+			}
+			inline const P LoadParameters(const float *t, int n) { return MaskedLoad<P>(FirstLanes<P>(n), t); }
+		}
+
+		void MultiplyQuaternions(const Quaternion *a, const Quaternion *b, Quaternion *out, size_t count) {
+			ForEachLanes(count, [=](size_t i, int n){
+				StoreQuaternions<P>(LoadQuaternions<P>(a + i, n) * LoadQuaternions<P>(b + i, n), out + i, n);
+			});
+		}
+
+		void NormalizeQuaternions(const Quaternion *in, Quaternion *out, size_t count) {
+			ForEachLanes(count, [=](size_t i, int n){
+				StoreQuaternions<P>(Normalize(LoadQuaternions<P>(in + i, n)), out + i, n);
+			});
+		}
+
+		void NlerpQuaternions(const float *t, const Quaternion *a, const Quaternion *b, Quaternion *out, size_t count) {
+			ForEachLanes(count, [=](size_t i, int n){
+				StoreQuaternions<P>(Nlerp(LoadParameters(t + i, n), LoadQuaternions<P>(a + i, n), LoadQuaternions<P>(b + i, n)), out + i, n);
+			});
+		}
+
+		void SlerpQuaternions(const float *t, const Quaternion *a, const Quaternion *b, Quaternion *out, size_t count) {
+			ForEachLanes(count, [=](size_t i, int n){
+				StoreQuaternions<P>(SlerpFast(LoadParameters(t + i, n), LoadQuaternions<P>(a + i, n), LoadQuaternions<P>(b + i, n)), out + i, n);
+			});
+		}
+
+		void RotateVectors(const Quaternion *q, const Vec3 *in, Vec3 *out, size_t count) {
+			ForEachLanes(count, [=](size_t i, int n){
+				StoreVec3<P>(LoadQuaternions<P>(q + i, n).Rotate(LoadVec3<P>(in + i, n)), out + i, n);
+			});
+		}
+
+		void RotationMatrices(const Quaternion *q, Matrix3x3 *out, size_t count) {
+			ForEachLanes(count, [=](size_t i, int n){
+				Vec<3, P> rows[3];
+				LoadQuaternions<P>(q + i, n).RotationMatrix(rows);
+				// each row of the packet is the same row of n matrices
+				Vec3 lanes[3][W];
+				for (int r = 0; r < 3; r++)
+					StoreVec3<P>(rows[r], lanes[r], n);
+				for (int k = 0; k < n; k++)
+					out[i + k] = Matrix3x3(lanes[0][k], lanes[1][k], lanes[2][k]);
+			});
+		}
+	}
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include "txbase/sse/packet.h"
+#include "txbase/sse/vmath.h"
+
+namespace TX {
+	namespace SSE {
+		/// <summary>
+		/// Quaternions in SoA form, a packet each of x, y, z and w, with the operations of Quaternion lane by lane.
+		/// </summary>
+		template<typename P>
+		struct QuaternionPacket {
+			static const int WIDTH = PacketTraits<P>::WIDTH;
+			P x, y, z, w;
+
+			inline QuaternionPacket() : x(0.f), y(0.f), z(0.f), w(1.f) {}
+			inline QuaternionPacket(const P& x, const P& y, const P& z, const P& w) : x(x), y(y), z(z), w(w) {}
+			inline QuaternionPacket(const Vec<3, P>& v, const P& w) : x(v.x), y(v.y), z(v.z), w(w) {}
+			inline explicit QuaternionPacket(const Quaternion& q) : x(q.x), y(q.y), z(q.z), w(q.w) {}
+
+			inline const QuaternionPacket operator - () const { return QuaternionPacket(-x, -y, -z, -w); }
+			inline const QuaternionPacket operator + (const QuaternionPacket& rhs) const { return QuaternionPacket(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w); }
+			inline const QuaternionPacket operator - (const QuaternionPacket& rhs) const { return QuaternionPacket(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w); }
+			inline const QuaternionPacket operator * (const P& s) const { return QuaternionPacket(x * s, y * s, z * s, w * s); }
+			inline const QuaternionPacket operator * (const QuaternionPacket& rhs) const {
+				return QuaternionPacket(
+					w*rhs.x + x*rhs.w + y*rhs.z - z*rhs.y,
+					w*rhs.y + y*rhs.w + z*rhs.x - x*rhs.z,
+					w*rhs.z + z*rhs.w + x*rhs.y - y*rhs.x,
+					w*rhs.w - x*rhs.x - y*rhs.y - z*rhs.z);
+			}
+			inline const QuaternionPacket Conjugate() const { return QuaternionPacket(-x, -y, -z, w); }
+
+			/// <summary>
+			/// Quaternion::Rotate() on a packet of vectors.
+			/// </summary>
+			inline const Vec<3, P> Rotate(const Vec<3, P>& v) const {
+				const P tx = w * v.x + y * v.z - z * v.y;
+				const P ty = w * v.y + z * v.x - x * v.z;
+				const P tz = w * v.z + x * v.y - y * v.x;
+				const P tw = -(x * v.x + y * v.y + z * v.z);
+				return Vec<3, P>(
+					tx * w - tw * x - ty * z + tz * y,
+					ty * w - tw * y - tz * x + tx * z,
+					tz * w - tw * z - tx * y + ty * x);
+			}
+
+			/// <summary>
+			/// The rows of the rotation matrix of a unit quaternion, Quaternion::RotationMatrix4x4() without the last row and column.
+			/// </summary>
+			inline void RotationMatrix(Vec<3, P> rows[3]) const {
+				const P twox = x + x, twoy = y + y, twoz = z + z;
+				const P twoxx = twox*x, twoyy = twoy*y, twozz = twoz*z;
+				const P twoxy = twox*y, twoyz = twoy*z, twozw = twoz*w, twoxz = twox*z, twoxw = twox*w, twoyw = twoy*w;
+				const P one(1.f);
+				rows[0] = Vec<3, P>(one - (twoyy + twozz), twoxy - twozw, twoxz + twoyw);
+				rows[1] = Vec<3, P>(twoxy + twozw, one - (twoxx + twozz), twoyz - twoxw);
+				rows[2] = Vec<3, P>(twoxz - twoyw, twoyz + twoxw, one - (twoxx + twoyy));
+			}
+
+			/// <summary>
+			/// Loads p[0..WIDTH) into the lanes, and stores them back.
+			/// </summary>
+			static inline const QuaternionPacket Load(const Quaternion *p) {
+				float lanes[4][WIDTH];
+				for (int i = 0; i < WIDTH; i++){
+					for (int c = 0; c < 4; c++)
+						lanes[c][i] = p[i].q[c];
+				}
+				return QuaternionPacket(SSE::Load<P>(lanes[0]), SSE::Load<P>(lanes[1]), SSE::Load<P>(lanes[2]), SSE::Load<P>(lanes[3]));
+			}
+			static inline void Store(const QuaternionPacket& q, Quaternion *p) {
+				float lanes[4][WIDTH];
+				SSE::Store(q.x, lanes[0]);
+				SSE::Store(q.y, lanes[1]);
+				SSE::Store(q.z, lanes[2]);
+				SSE::Store(q.w, lanes[3]);
+				for (int i = 0; i < WIDTH; i++)
+					p[i] = Quaternion(lanes[0][i], lanes[1][i], lanes[2][i], lanes[3][i]);
+			}
+		};
+
+		typedef QuaternionPacket<V4Float> QuaternionV4;
+#ifdef __AVX2__
+		typedef QuaternionPacket<V8Float> QuaternionV8;
+#endif
+#ifdef __AVX512F__
+		typedef QuaternionPacket<V16Float> QuaternionV16;
+#endif
+
+		// four quaternions are a 4x4 transpose away from SoA
+		template<>
+		inline const QuaternionV4 QuaternionV4::Load(const Quaternion *p) {
+			__m128 q0 = _mm_loadu_ps(&p[0].x), q1 = _mm_loadu_ps(&p[1].x), q2 = _mm_loadu_ps(&p[2].x), q3 = _mm_loadu_ps(&p[3].x);
+			_MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+			return QuaternionV4(q0, q1, q2, q3);
+		}
+		template<>
+		inline void QuaternionV4::Store(const QuaternionV4& q, Quaternion *p) {
+			__m128 q0 = q.x, q1 = q.y, q2 = q.z, q3 = q.w;
+			_MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+			_mm_storeu_ps(&p[0].x, q0);
+			_mm_storeu_ps(&p[1].x, q1);
+			_mm_storeu_ps(&p[2].x, q2);
+			_mm_storeu_ps(&p[3].x, q3);
+		}
+#ifdef __AVX2__
+		// the same transpose in each 128 bit half, quaternions 0-3 in the low halves and 4-7 in the high ones
+		template<>
+		inline const QuaternionV8 QuaternionV8::Load(const Quaternion *p) {
+			const float *src = &p->x;
+			__m256 q[4];
+			for (int i = 0; i < 4; i++)
+				q[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4 * i)), _mm_loadu_ps(src + 16 + 4 * i), 1);
+			const __m256 t0 = _mm256_unpacklo_ps(q[0], q[1]), t1 = _mm256_unpacklo_ps(q[2], q[3]);
+			const __m256 t2 = _mm256_unpackhi_ps(q[0], q[1]), t3 = _mm256_unpackhi_ps(q[2], q[3]);
+			return QuaternionV8(
+				_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2)));
+		}
+		template<>
+		inline void QuaternionV8::Store(const QuaternionV8& v, Quaternion *p) {
+			float *dst = &p->x;
+			const __m256 t0 = _mm256_unpacklo_ps(v.x, v.y), t1 = _mm256_unpacklo_ps(v.z, v.w);
+			const __m256 t2 = _mm256_unpackhi_ps(v.x, v.y), t3 = _mm256_unpackhi_ps(v.z, v.w);
+			const __m256 q[4] = {
+				_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2)) };
+			for (int i = 0; i < 4; i++){
+				_mm_storeu_ps(dst + 4 * i, _mm256_castps256_ps128(q[i]));
+				_mm_storeu_ps(dst + 16 + 4 * i, _mm256_extractf128_ps(q[i], 1));
+			}
+		}
+#endif
+
+		/// <summary>
+		/// Loads p[0..n) into the first n lanes, the others are the identity. n is at most the width of P.
+		/// </summary>
+		template<typename P>
+		inline const QuaternionPacket<P> LoadQuaternions(const Quaternion *p, int n = QuaternionPacket<P>::WIDTH) {
+			if (n == QuaternionPacket<P>::WIDTH)
+				return QuaternionPacket<P>::Load(p);
+			Quaternion lanes[QuaternionPacket<P>::WIDTH];
+			std::copy(p, p + n, lanes);
+			return QuaternionPacket<P>::Load(lanes);
+		}
+		/// <summary>
+		/// Stores the first n lanes to p[0..n).
+		/// </summary>
+		template<typename P>
+		inline void StoreQuaternions(const QuaternionPacket<P>& q, Quaternion *p, int n = QuaternionPacket<P>::WIDTH) {
+			if (n == QuaternionPacket<P>::WIDTH){
+				QuaternionPacket<P>::Store(q, p);
+				return;
+			}
+			Quaternion lanes[QuaternionPacket<P>::WIDTH];
+			QuaternionPacket<P>::Store(q, lanes);
+			std::copy(lanes, lanes + n, p);
+		}
+
+		template<typename P>
+		inline const P Dot(const QuaternionPacket<P>& a, const QuaternionPacket<P>& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+		template<typename P>
+		inline const QuaternionPacket<P> Normalize(const QuaternionPacket<P>& q) { return q * Rsqrt(Dot(q, q)); }
+
+		/// <summary>
+		/// Normalized linear interpolation from a to b along the shorter arc, b is negated where Dot(a, b) < 0.
+		/// </summary>
+		template<typename P>
+		inline const QuaternionPacket<P> Nlerp(const P& t, const QuaternionPacket<P>& a, const QuaternionPacket<P>& b) {
+			const P wb = VMath::XorSign(t, Dot(a, b));
+			return Normalize(a * (P(1.f) - t) + b * wb);
+		}
+
+		/// <summary>
+		/// Spherical linear interpolation of unit quaternions along the shorter arc: per lane,
+		/// Math::Slerp(t, a, Dot(a, b) < 0 ? -b : b), within a few ulps of it.
+		/// </summary>
+		template<typename P>
+		inline const QuaternionPacket<P> Slerp(const P& t, const QuaternionPacket<P>& a, const QuaternionPacket<P>& b) {
+			const P d = Dot(a, b);
+			const P c = Min(Abs(d), P(1.f));
+			// the weights tend to 1 - t and t where the arc is too short for sin(theta) to be divided by
+			const auto short_arc = c > P(1.f - 1e-6f);
+			const P theta = VMath::Acos(c);
+			const P rcp = Rcp(Select(short_arc, P(1.f), VMath::Sin(theta)));
+			const P wa = Select(short_arc, P(1.f) - t, VMath::Sin((P(1.f) - t) * theta) * rcp);
+			const P wb = Select(short_arc, t, VMath::Sin(t * theta) * rcp);
+			return a * wa + b * VMath::XorSign(wb, d);
+		}
+
+		// sin(t theta) / sin(theta) for x = cos(theta) in [0, 1], from its series in x - 1
+		template<typename P>
+		inline const P SlerpWeight(const P& t, const P& xm1) {
+			// 1 / (i (2i + 1)) and i / (2i + 1) for i = 1..8, the last pair scaled to make up for the truncated terms
+			static const float U[8] = { 1.f / 3, 1.f / 10, 1.f / 21, 1.f / 36, 1.f / 55, 1.f / 78, 1.f / 105, 1.85298109240830f / 136 };
+			static const float V[8] = { 1.f / 3, 2.f / 5, 3.f / 7, 4.f / 9, 5.f / 11, 6.f / 13, 7.f / 15, 1.85298109240830f * 8 / 17 };
+			const P tt = t * t;
+			P r(1.f);
+			for (int i = 7; i >= 0; i--)
+				r = MulAdd(MulSub(P(U[i]), tt, P(V[i])) * xm1, r, P(1.f));
+			return t * r;
+		}
+		/// <summary>
+		/// Slerp() without trigonometry, the weights are polynomials in t and Dot(a, b) with absolute error below 2e-5
+		/// (D. Eberly, A Fast and Accurate Algorithm for Computing SLERP).
+		/// </summary>
+		template<typename P>
+		inline const QuaternionPacket<P> SlerpFast(const P& t, const QuaternionPacket<P>& a, const QuaternionPacket<P>& b) {
+			const P d = Dot(a, b);
+			const P xm1 = Min(Abs(d), P(1.f)) - P(1.f);
+			const P wa = SlerpWeight(P(1.f) - t, xm1);
+			const P wb = SlerpWeight(t, xm1);
+			return a * wa + b * VMath::XorSign(wb, d);
+		}
+
+		/// <summary>
+		/// The operations above over arrays of count quaternions, a native packet at a time. out may be the same array as an input.
+		/// Slerps use SlerpFast(), t holds a parameter per quaternion.
+		/// </summary>
+		void MultiplyQuaternions(const Quaternion *a, const Quaternion *b, Quaternion *out, size_t count);
+		void NormalizeQuaternions(const Quaternion *in, Quaternion *out, size_t count);
+		void NlerpQuaternions(const float *t, const Quaternion *a, const Quaternion *b, Quaternion *out, size_t count);
+		void SlerpQuaternions(const float *t, const Quaternion *a, const Quaternion *b, Quaternion *out, size_t count);
+		/// <summary>
+		/// out[i] = q[i].Rotate(in[i]).
+		/// </summary>
+		void RotateVectors(const Quaternion *q, const Vec3 *in, Vec3 *out, size_t count);
+		/// <summary>
+		/// out[i] = Matrix3x3(q[i].RotationMatrix4x4()) for unit quaternions.
+		/// </summary>
+		void RotationMatrices(const Quaternion *q, Matrix3x3 *out, size_t count);
+	}
+}
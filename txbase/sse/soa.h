@@ -0,0 +1,194 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include "txbase/sse/packet.h"
+
+namespace TX {
+	namespace SSE {
+		/// <summary>
+		/// Four Vec3 as they lie in memory, three registers x0y0z0x1 y1z1x2y2 z2x3y3z3, to the x, y and z of the four.
+		/// The V8Float version does the same in each 128 bit half.
+		/// </summary>
+		inline void Transpose4x3(const V4Float& m0, const V4Float& m1, const V4Float& m2, V4Float& x, V4Float& y, V4Float& z) {
+			const __m128 xy = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+			const __m128 yz = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+			x = _mm_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+			y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			z = _mm_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+		}
+		/// <summary>
+		/// Inverse of Transpose4x3().
+		/// </summary>
+		inline void Transpose3x4(const V4Float& x, const V4Float& y, const V4Float& z, V4Float& m0, V4Float& m1, V4Float& m2) {
+			const __m128 xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+			const __m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+			const __m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+			m0 = _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+			m1 = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			m2 = _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		/// <summary>
+		/// Loads p[0..4) into the lanes of a Vec3V4F, and stores them back.
+		/// </summary>
+		inline const Vec3V4F LoadVec3x4(const Vec3 *p) {
+			const float *src = &p->x;
+			Vec3V4F v;
+			Transpose4x3(_mm_loadu_ps(src), _mm_loadu_ps(src + 4), _mm_loadu_ps(src + 8), v.x, v.y, v.z);
+			return v;
+		}
+		inline void StoreVec3x4(const Vec3V4F& v, Vec3 *p) {
+			float *dst = &p->x;
+			V4Float m0, m1, m2;
+			Transpose3x4(v.x, v.y, v.z, m0, m1, m2);
+			_mm_storeu_ps(dst, m0);
+			_mm_storeu_ps(dst + 4, m1);
+			_mm_storeu_ps(dst + 8, m2);
+		}
+
+#ifdef __AVX2__
+		inline void Transpose4x3(const V8Float& m0, const V8Float& m1, const V8Float& m2, V8Float& x, V8Float& y, V8Float& z) {
+			const __m256 xy = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+			const __m256 yz = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+			x = _mm256_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+			y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			z = _mm256_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+		}
+		inline void Transpose3x4(const V8Float& x, const V8Float& y, const V8Float& z, V8Float& m0, V8Float& m1, V8Float& m2) {
+			const __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+			const __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+			const __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+			m0 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+			m1 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			m2 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		/// <summary>
+		/// Loads p[0..8) into the lanes of a Vec3V8F, and stores them back.
+		/// Points 0-3 go through the low halves of the registers and 4-7 through the high ones.
+		/// </summary>
+		inline const Vec3V8F LoadVec3x8(const Vec3 *p) {
+			const float *src = &p->x;
+			const V8Float m03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)), _mm_loadu_ps(src + 12), 1);
+			const V8Float m14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 16), 1);
+			const V8Float m25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 20), 1);
+			Vec3V8F v;
+			Transpose4x3(m03, m14, m25, v.x, v.y, v.z);
+			return v;
+		}
+		inline void StoreVec3x8(const Vec3V8F& v, Vec3 *p) {
+			float *dst = &p->x;
+			V8Float m03, m14, m25;
+			Transpose3x4(v.x, v.y, v.z, m03, m14, m25);
+			_mm_storeu_ps(dst, _mm256_castps256_ps128(m03));
+			_mm_storeu_ps(dst + 4, _mm256_castps256_ps128(m14));
+			_mm_storeu_ps(dst + 8, _mm256_castps256_ps128(m25));
+			_mm_storeu_ps(dst + 12, _mm256_extractf128_ps(m03, 1));
+			_mm_storeu_ps(dst + 16, _mm256_extractf128_ps(m14, 1));
+			_mm_storeu_ps(dst + 20, _mm256_extractf128_ps(m25, 1));
+		}
+#endif
+
+		/// <summary>
+		/// Loads and stores of WIDTH consecutive Vec3 as a Vec of packets, the native types use the transposes above.
+		/// </summary>
+		template<typename P>
+		struct Vec3Packet {
+			static const int WIDTH = PacketTraits<P>::WIDTH;
+			static inline const Vec<3, P> Load(const Vec3 *p) {
+				Vec<3, P> v;
+				for (int i = 0; i < WIDTH; i++){
+					v.x[i] = p[i].x;
+					v.y[i] = p[i].y;
+					v.z[i] = p[i].z;
+				}
+				return v;
+			}
+			static inline void Store(const Vec<3, P>& v, Vec3 *p) {
+				for (int i = 0; i < WIDTH; i++)
+					p[i] = Vec3(v.x[i], v.y[i], v.z[i]);
+			}
+		};
+		template<> struct Vec3Packet<float> {
+			static const int WIDTH = 1;
+			static inline const Vec3 Load(const Vec3 *p) { return *p; }
+			static inline void Store(const Vec3& v, Vec3 *p) { *p = v; }
+		};
+		template<> struct Vec3Packet<V4Float> {
+			static const int WIDTH = 4;
+			static inline const Vec3V4F Load(const Vec3 *p) { return LoadVec3x4(p); }
+			static inline void Store(const Vec3V4F& v, Vec3 *p) { StoreVec3x4(v, p); }
+		};
+#ifdef __AVX2__
+		template<> struct Vec3Packet<V8Float> {
+			static const int WIDTH = 8;
+			static inline const Vec3V8F Load(const Vec3 *p) { return LoadVec3x8(p); }
+			static inline void Store(const Vec3V8F& v, Vec3 *p) { StoreVec3x8(v, p); }
+		};
+#endif
+#ifdef __AVX512F__
+		template<> struct Vec3Packet<V16Float> {
+			static const int WIDTH = 16;
+			static inline const Vec3V16F Load(const Vec3 *p) {
+				const Vec3V8F lo = LoadVec3x8(p), hi = LoadVec3x8(p + 8);
+				return Vec3V16F(V16Float(lo.x, hi.x), V16Float(lo.y, hi.y), V16Float(lo.z, hi.z));
+			}
+			static inline void Store(const Vec3V16F& v, Vec3 *p) {
+				StoreVec3x8(Vec3V8F(v.x.Low(), v.y.Low(), v.z.Low()), p);
+				StoreVec3x8(Vec3V8F(v.x.High(), v.y.High(), v.z.High()), p + 8);
+			}
+		};
+#endif
+
+		/// <summary>
+		/// Loads p[0..n) into the first n lanes, the others are zero. n is at most the width of P.
+		/// </summary>
+		template<typename P>
+		inline const Vec<3, P> LoadVec3(const Vec3 *p, int n = Vec3Packet<P>::WIDTH) {
+			if (n == Vec3Packet<P>::WIDTH)
+				return Vec3Packet<P>::Load(p);
+			Vec3 lanes[Vec3Packet<P>::WIDTH];
+			std::copy(p, p + n, lanes);
+			return Vec3Packet<P>::Load(lanes);
+		}
+		/// <summary>
+		/// Stores the first n lanes to p[0..n).
+		/// </summary>
+		template<typename P>
+		inline void StoreVec3(const Vec<3, P>& v, Vec3 *p, int n = Vec3Packet<P>::WIDTH) {
+			if (n == Vec3Packet<P>::WIDTH){
+				Vec3Packet<P>::Store(v, p);
+				return;
+			}
+			Vec3 lanes[Vec3Packet<P>::WIDTH];
+			Vec3Packet<P>::Store(v, lanes);
+			std::copy(lanes, lanes + n, p);
+		}
+
+		/// <summary>
+		/// Calls f(const Vec<3, P>& v, size_t first, int lanes) for in[0..count) in packets of P,
+		/// v holding in[first..first + lanes), the lanes of the last packet past the end are zero.
+		/// </summary>
+		template<typename P, typename F>
+		inline void ForEachPacket(const Vec3 *in, size_t count, F f) {
+			const int W = Vec3Packet<P>::WIDTH;
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				f(Vec3Packet<P>::Load(in + i), i, W);
+			if (i < count)
+				f(LoadVec3<P>(in + i, int(count - i)), i, int(count - i));
+		}
+		/// <summary>
+		/// out[i] = f(in[i]) for i in [0, count), f taking and returning Vec<3, P>. out may be the same array as in.
+		/// </summary>
+		template<typename P, typename F>
+		inline void ForEachPacket(const Vec3 *in, Vec3 *out, size_t count, F f) {
+			const int W = Vec3Packet<P>::WIDTH;
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				Vec3Packet<P>::Store(f(Vec3Packet<P>::Load(in + i)), out + i);
+			if (i < count)
+				StoreVec3<P>(f(LoadVec3<P>(in + i, int(count - i))), out + i, int(count - i));
+		}
+	}
+}
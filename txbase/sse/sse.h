@@ -12,6 +12,12 @@
 #include "txbase/sse/bool.h"
 #include "txbase/sse/int.h"
 #include "txbase/sse/float.h"
+#include "txbase/sse/bool8.h"
+#include "txbase/sse/int8.h"
+#include "txbase/sse/float8.h"
+#include "txbase/sse/bool16.h"
+#include "txbase/sse/int16.h"
+#include "txbase/sse/float16.h"
 
 namespace TX {
 	namespace SSE {
@@ -26,5 +32,33 @@ namespace TX {
 		typedef Vec<2, V4Float> Vec2V4F;
 		typedef Vec<3, V4Float> Vec3V4F;
 		typedef Vec<4, V4Float> Vec4V4F;
+
+#ifdef __AVX2__
+		typedef Vec<2, V8Bool> Vec2V8B;
+		typedef Vec<3, V8Bool> Vec3V8B;
+		typedef Vec<4, V8Bool> Vec4V8B;
+
+		typedef Vec<2, V8Int> Vec2V8I;
+		typedef Vec<3, V8Int> Vec3V8I;
+		typedef Vec<4, V8Int> Vec4V8I;
+
+		typedef Vec<2, V8Float> Vec2V8F;
+		typedef Vec<3, V8Float> Vec3V8F;
+		typedef Vec<4, V8Float> Vec4V8F;
+#endif
+
+#ifdef __AVX512F__
+		typedef Vec<2, V16Bool> Vec2V16B;
+		typedef Vec<3, V16Bool> Vec3V16B;
+		typedef Vec<4, V16Bool> Vec4V16B;
+
+		typedef Vec<2, V16Int> Vec2V16I;
+		typedef Vec<3, V16Int> Vec3V16I;
+		typedef Vec<4, V16Int> Vec4V16I;
+
+		typedef Vec<2, V16Float> Vec2V16F;
+		typedef Vec<3, V16Float> Vec3V16F;
+		typedef Vec<4, V16Float> Vec4V16F;
+#endif
 	}
 }
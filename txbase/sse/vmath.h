@@ -0,0 +1,214 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include "txbase/sse/packet.h"
+
+namespace TX {
+	namespace SSE {
+		/// <summary>
+		/// Trigonometry on any float packet: float, V4Float, V8Float, V16Float or a PacketArray.
+		/// Each function comes in two tiers. The plain one is within a few ulps of the correctly rounded result
+		/// (the Cephes single precision polynomials with the argument reduction split in parts),
+		/// the Fast one trades that for shorter polynomials with the absolute error noted on it.
+		/// </summary>
+		namespace VMath {
+			const float PI_HI = 3.14159274101257324f;
+			const float PI_LO = -8.742278e-8f;
+			const float PIO2_HI = 1.57079637050628662f;
+			const float PIO2_LO = -4.371139e-8f;
+			const float PIO4_HI = 0.785398185253143310546875f;
+			const float PIO4_LO = -2.1855695e-8f;
+			const float TWO_OVER_PI = 0.636619772367581343f;
+
+			/// <summary>
+			/// Sign bit of b applied to a.
+			/// </summary>
+			template<typename P>
+			inline const P XorSign(const P& a, const P& b) { return a ^ (b & P(-0.f)); }
+			template<int W>
+			inline const PacketArray<float, W> XorSign(const PacketArray<float, W>& a, const PacketArray<float, W>& b) {
+				return a.Map(b, [](float x, float y){ return std::signbit(y) ? -x : x; });
+			}
+			inline float XorSign(float a, float b) { return std::signbit(b) ? -a : a; }
+
+			/// <summary>
+			/// Sine and cosine of x in radians, within 1 ulp for |x| < 8192.
+			/// </summary>
+			template<typename P>
+			inline void SinCos(const P& x, P *s, P *c) {
+				// x = j * pi/2 + r with |r| <= pi/4. pi/2 is split in five parts, the first four of 11 bits,
+				// so that j * part is exact for j < 2^13 whether MulAdd is fused or not. r stays precise next
+				// to the multiples of pi/2, and lo keeps what the last three steps round off
+				const P j = Floor(MulAdd(x, P(TWO_OVER_PI), P(0.5f)));
+				P r = MulAdd(j, P(-1.5703125f), x);
+				r = MulAdd(j, P(-4.837512969970703125e-4f), r);
+				P t = j * P(7.549533620476722717285156e-8f);
+				P rn = r - t;
+				P lo = (r - rn) - t;
+				r = rn;
+				t = j * P(2.563282919254561420530081e-12f);
+				rn = r - t;
+				lo = lo + ((r - rn) - t);
+				r = rn;
+				t = j * P(6.123234262925839272231898e-17f);
+				rn = r - t;
+				lo = lo + ((r - rn) - t);
+				r = rn;
+				const P z = r * r;
+
+				// sin(r + lo) = sin r + lo cos r, cos(r + lo) = cos r - lo sin r, with 1 - z/2 summed exactly
+				const P h = NegMulAdd(P(0.5f), z, P(1.f));
+				const P h_lo = NegMulAdd(P(0.5f), z, P(1.f) - h);
+				P ps = MulAdd(MulAdd(P(-1.9515295891e-4f), z, P(8.3321608736e-3f)), z, P(-1.6666654611e-1f));
+				ps = r + MulAdd(ps * z, r, lo * h);
+				P pc = MulAdd(MulAdd(P(2.443315711809948e-5f), z, P(-1.388731625493765e-3f)), z, P(4.166664568298827e-2f));
+				pc = h + MulAdd(pc * z, z, NegMulAdd(r, lo, h_lo));
+
+				// quadrant 0..3: sin is (sin r, cos r, -sin r, -cos r), cos is (cos r, -sin r, -cos r, sin r)
+				const P q = j - P(4.f) * Floor(j * P(0.25f));
+				const auto odd = (q - P(2.f) * Floor(q * P(0.5f))) > P(0.5f);
+				const P sr = Select(odd, pc, ps);
+				const P cr = Select(odd, ps, pc);
+				*s = Select(q > P(1.5f), -sr, sr);
+				*c = Select(Abs(q - P(1.5f)) < P(1.f), -cr, cr);
+			}
+			template<typename P>
+			inline const P Sin(const P& x) { P s, c; SinCos(x, &s, &c); return s; }
+			template<typename P>
+			inline const P Cos(const P& x) { P s, c; SinCos(x, &s, &c); return c; }
+
+			/// <summary>
+			/// Sine and cosine, absolute error below 2e-6 for |x| < 8192.
+			/// </summary>
+			template<typename P>
+			inline void SinCosFast(const P& x, P *s, P *c) {
+				// pi/2 in three parts, j * part is exact for the first two like in SinCos()
+				const P j = Floor(MulAdd(x, P(TWO_OVER_PI), P(0.5f)));
+				P r = MulAdd(j, P(-1.5703125f), x);
+				r = MulAdd(j, P(-4.837512969970703125e-4f), r);
+				r = MulAdd(j, P(-7.54978995489188216e-8f), r);
+				const P z = r * r;
+
+				const P ps = MulAdd(r * z, MulAdd(z, P(0.008164607971365409f), P(-0.1666345849302265f)), r);
+				const P pc = MulAdd(z, MulAdd(z, MulAdd(z, P(-0.00135978221254165f), P(0.041656294488243026f)), P(-0.49999894779457166f)), P(1.f));
+
+				const P q = j - P(4.f) * Floor(j * P(0.25f));
+				const auto odd = (q - P(2.f) * Floor(q * P(0.5f))) > P(0.5f);
+				const P sr = Select(odd, pc, ps);
+				const P cr = Select(odd, ps, pc);
+				*s = Select(q > P(1.5f), -sr, sr);
+				*c = Select(Abs(q - P(1.5f)) < P(1.f), -cr, cr);
+			}
+
+			/// <summary>
+			/// Arc tangent, within 2 ulps.
+			/// </summary>
+			template<typename P>
+			inline const P Atan(const P& x) {
+				// reduce to |t| <= tan(pi/8) with atan(a) = pi/2 + atan(-1/a) = pi/4 + atan((a-1)/(a+1))
+				const P a = Abs(x);
+				const auto big = a > P(2.414213562373095f);
+				const auto mid = a > P(0.4142135623730950f);
+				P t = Select(mid, (a - P(1.f)) / (a + P(1.f)), a);
+				t = Select(big, -Rcp(a), t);
+				const P hi = Select(big, P(PIO2_HI), Select(mid, P(PIO4_HI), P(0.f)));
+				const P lo = Select(big, P(PIO2_LO), Select(mid, P(PIO4_LO), P(0.f)));
+
+				const P z = t * t;
+				P p = MulAdd(MulAdd(MulAdd(P(8.05374449538e-2f), z, P(-1.38776856032e-1f)), z, P(1.99777106478e-1f)), z, P(-3.33329491539e-1f));
+				p = MulAdd(p * z, t, t);
+				return XorSign(hi + (p + lo), x);
+			}
+
+			/// <summary>
+			/// Angle of the point (x, y) in [-pi, pi], within 4 ulps. Zero for the origin,
+			/// +-pi/4 or +-3pi/4 when both are infinite.
+			/// </summary>
+			template<typename P>
+			inline const P Atan2(const P& y, const P& x) {
+				const P ax = Abs(x), ay = Abs(y);
+				const P den = Max(ax, ay);
+				// the ratio is exactly 1 on the diagonals, where inf / inf would give NaN
+				const P t = Select(ax == ay, P(1.f), Min(ax, ay) / den);
+				P r = Atan(Select(den > P(0.f), t, P(0.f)));
+				r = Select(ay > ax, (P(PIO2_HI) - r) + P(PIO2_LO), r);
+				r = Select(XorSign(P(1.f), x) < P(0.f), (P(PI_HI) - r) + P(PI_LO), r);
+				return XorSign(r, y);
+			}
+
+			// asin(s) for 0 <= s <= 0.5, z = s * s
+			template<typename P>
+			inline const P AsinHalf(const P& s, const P& z) {
+				const P p = MulAdd(MulAdd(MulAdd(MulAdd(P(4.2163199048e-2f), z, P(2.4181311049e-2f)), z, P(4.5470025998e-2f)), z, P(7.4953002686e-2f)), z, P(1.6666752422e-1f));
+				return MulAdd(p * z, s, s);
+			}
+			/// <summary>
+			/// Arc sine and arc cosine, within 2 ulps. NaN outside [-1, 1].
+			/// </summary>
+			template<typename P>
+			inline const P Asin(const P& x) {
+				// asin(a) = pi/2 - 2 asin(sqrt((1 - a) / 2)) above 0.5
+				const P a = Abs(x);
+				const auto big = a > P(0.5f);
+				const P zb = P(0.5f) * (P(1.f) - a);
+				const P p = AsinHalf(Select(big, Sqrt(zb), a), Select(big, zb, a * a));
+				return XorSign(Select(big, (P(PIO2_HI) - (p + p)) + P(PIO2_LO), p), x);
+			}
+			template<typename P>
+			inline const P Acos(const P& x) {
+				const P a = Abs(x);
+				const auto big = a > P(0.5f);
+				const P zb = P(0.5f) * (P(1.f) - a);
+				const P p = AsinHalf(Select(big, Sqrt(zb), a), Select(big, zb, a * a));
+				const P inner = (P(PIO2_HI) - XorSign(p, x)) + P(PIO2_LO);
+				const P outer = Select(x < P(0.f), (P(PI_HI) - (p + p)) + P(PI_LO), p + p);
+				return Select(big, outer, inner);
+			}
+
+			// atan(t) for 0 <= t <= 1
+			template<typename P>
+			inline const P AtanFast01(const P& t) {
+				const P z = t * t;
+				const P p = MulAdd(MulAdd(MulAdd(MulAdd(P(0.020845096040207827f), z, P(-0.08515633044404083f)), z, P(0.18015930203425518f)), z, P(-0.33030479801617213f)), z, P(0.9998663320253229f));
+				return p * t;
+			}
+			/// <summary>
+			/// Arc tangent, absolute error below 2e-5.
+			/// </summary>
+			template<typename P>
+			inline const P AtanFast(const P& x) {
+				const P a = Abs(x);
+				const auto inv = a > P(1.f);
+				const P p = AtanFast01(Select(inv, P(1.f) / a, a));
+				return XorSign(Select(inv, P(PIO2_HI) - p, p), x);
+			}
+
+			/// <summary>
+			/// Angle of the point (x, y) in [-pi, pi], absolute error below 2e-5. Handles zeros and infinities like Atan2().
+			/// </summary>
+			template<typename P>
+			inline const P Atan2Fast(const P& y, const P& x) {
+				const P ax = Abs(x), ay = Abs(y);
+				const P den = Max(ax, ay);
+				const P t = Select(ax == ay, P(1.f), Min(ax, ay) / den);
+				P r = AtanFast01(Select(den > P(0.f), t, P(0.f)));
+				r = Select(ay > ax, P(PIO2_HI) - r, r);
+				r = Select(XorSign(P(1.f), x) < P(0.f), P(PI_HI) - r, r);
+				return XorSign(r, y);
+			}
+
+			/// <summary>
+			/// Arc cosine and arc sine, absolute error below 1e-4.
+			/// </summary>
+			template<typename P>
+			inline const P AcosFast(const P& x) {
+				// Abramowitz and Stegun 4.4.45
+				const P a = Abs(x);
+				const P p = SqrtFast(P(1.f) - a) * MulAdd(MulAdd(MulAdd(P(-0.0187293f), a, P(0.0742610f)), a, P(-0.2121144f)), a, P(1.5707288f));
+				return Select(x < P(0.f), P(PI_HI) - p, p);
+			}
+			template<typename P>
+			inline const P AsinFast(const P& x) { return P(PIO2_HI) - AcosFast(x); }
+		}
+	}
+}
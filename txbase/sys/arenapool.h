@@ -0,0 +1,70 @@
+#pragma once
+
+#include "txbase/sys/memory.h"
+#include "txbase/sys/thread.h"
+
+namespace TX
+{
+	/// <summary>
+	/// One MemoryArena per scheduler thread, picked by the id passed to Task::Run(), so that parallel code can
+	/// allocate temporaries without locking. Threads outside of the pool share the last arena (id ThreadCount()),
+	/// like they share the helping slot of the scheduler: only one of them may use it at a time.
+	/// The pool is sized for the workers running when it is created.
+	/// </summary>
+	class ArenaPool : NonCopyable {
+	private:
+		struct Slot {
+			Slot(uint32_t blockSize) : arena(blockSize) {}
+			MemoryArena arena;
+			char padding[64];	// keeps the bookkeeping of neighbouring arenas off each other's cache lines
+		};
+	public:
+		ArenaPool(TaskScheduler *scheduler = TaskScheduler::Instance(), uint32_t blockSize = 32768) : scheduler_(scheduler) {
+			int count = scheduler->ThreadCount() + 1;
+			for (int i = 0; i < count; i++)
+				slots_.emplace_back(new Slot(blockSize));
+		}
+
+		inline int Size() const { return int(slots_.size()); }
+		/// <summary>
+		/// The arena of the thread running a task with the given id.
+		/// </summary>
+		inline MemoryArena& operator [] (int id) {
+			assert(id >= 0 && id < Size() && "the scheduler has more workers than when the pool was created");
+			return slots_[id]->arena;
+		}
+		/// <summary>
+		/// The arena of the calling thread.
+		/// </summary>
+		inline MemoryArena& Local() { return (*this)[scheduler_->CurrentThreadId()]; }
+
+		/// <summary>
+		/// Frees the allocations of every arena, e.g. at the end of a frame. No task may be using the pool.
+		/// </summary>
+		inline void FreeAll() {
+			for (auto& slot : slots_)
+				slot->arena.FreeAll();
+		}
+		/// <summary>
+		/// Per-thread usage, read while no task is using the pool.
+		/// </summary>
+		inline size_t BytesUsed(int id) const { return slots_[id]->arena.BytesUsed(); }
+		inline size_t PeakBytesUsed(int id) const { return slots_[id]->arena.PeakBytesUsed(); }
+		inline size_t BytesReserved(int id) const { return slots_[id]->arena.BytesReserved(); }
+		size_t TotalBytesUsed() const {
+			size_t total = 0;
+			for (auto& slot : slots_)
+				total += slot->arena.BytesUsed();
+			return total;
+		}
+		size_t TotalBytesReserved() const {
+			size_t total = 0;
+			for (auto& slot : slots_)
+				total += slot->arena.BytesReserved();
+			return total;
+		}
+	private:
+		TaskScheduler *scheduler_;
+		std::vector<std::unique_ptr<Slot>> slots_;
+	};
+}
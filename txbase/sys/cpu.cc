@@ -0,0 +1,271 @@
+#include "txbase/stdafx.h"
+#include "cpu.h"
+
+#include <map>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+namespace TX
+{
+#if defined(__linux__)
+	namespace {
+		/// <summary>
+		/// Reads a single integer from a sysfs file, returns the fallback if the file doesn't exist.
+		/// </summary>
+		int ReadSysInt(const std::string& path, int fallback){
+			std::ifstream file(path);
+			int value;
+			if (file >> value)
+				return value;
+			return fallback;
+		}
+
+		/// <summary>
+		/// Parses a sysfs cpu list such as "0-3,8-11".
+		/// </summary>
+		std::vector<int> ReadSysCpuList(const std::string& path){
+			std::vector<int> cpus;
+			std::ifstream file(path);
+			std::string list;
+			if (!(file >> list))
+				return cpus;
+			std::stringstream ss(list);
+			std::string range;
+			while (std::getline(ss, range, ',')){
+				size_t dash = range.find('-');
+				int first = std::atoi(range.c_str());
+				int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+				for (int cpu = first; cpu <= last; cpu++)
+					cpus.push_back(cpu);
+			}
+			return cpus;
+		}
+	}
+#endif
+
+	namespace {
+		/// <summary>
+		/// Registers eax, ebx, ecx, edx of cpuid, all zeros if the leaf isn't supported.
+		/// </summary>
+		void CpuId(int leaf, int subleaf, uint32_t regs[4]){
+			regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < leaf) return;
+			__cpuidex(info, leaf, subleaf);
+			for (int i = 0; i < 4; i++)
+				regs[i] = uint32_t(info[i]);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			if (uint32_t(leaf) > __get_cpuid_max(0, nullptr)) return;
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		}
+
+		/// <summary>
+		/// The extended control register XCR0, which tells which register states the OS saves.
+		/// </summary>
+		uint64_t XGetBV(){
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			uint32_t eax, edx;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (uint64_t(edx) << 32) | eax;
+#else
+			return 0;
+#endif
+		}
+	}
+
+	const CpuFeatures& CpuFeatures::Get(){
+		static CpuFeatures features;
+		return features;
+	}
+
+	CpuFeatures::CpuFeatures(){
+		Detect();
+	}
+
+	void CpuFeatures::Detect(){
+		uint32_t regs[4];
+		CpuId(1, 0, regs);
+		sse41 = (regs[2] >> 19) & 1;
+		fma = (regs[2] >> 12) & 1;
+		bool osxsave = (regs[2] >> 27) & 1;
+		bool cpu_avx = (regs[2] >> 28) & 1;
+		uint64_t xcr0 = osxsave ? XGetBV() : 0;
+		bool os_avx = (xcr0 & 0x6) == 0x6;				// xmm and ymm
+		bool os_avx512 = (xcr0 & 0xe6) == 0xe6;		// and opmask, zmm
+		avx = cpu_avx && os_avx;
+		fma = fma && avx;
+		CpuId(7, 0, regs);
+		avx2 = avx && ((regs[1] >> 5) & 1);
+		avx512f = avx && os_avx512 && ((regs[1] >> 16) & 1);
+	}
+
+	SimdLevel CpuFeatures::Level() const {
+		SimdLevel level = SimdLevel::SSE41;
+		if (Supports(SimdLevel::AVX512))
+			level = SimdLevel::AVX512;
+		else if (Supports(SimdLevel::AVX2))
+			level = SimdLevel::AVX2;
+		if (const char *env = std::getenv("TX_SIMD_LEVEL")){
+			std::string name(env);
+			SimdLevel limit = name == "sse41" ? SimdLevel::SSE41 : name == "avx2" ? SimdLevel::AVX2 : SimdLevel::AVX512;
+			level = std::min(level, limit);
+		}
+		return level;
+	}
+
+	const CpuTopology& CpuTopology::Get(){
+		static CpuTopology topology;
+		return topology;
+	}
+
+	CpuTopology::CpuTopology() : node_count_(1) {
+		Detect();
+		if (processors_.empty()){
+			// unknown platform, assume one core per processor on a single node
+			int count = Math::Max(1, int(std::thread::hardware_concurrency()));
+			for (int i = 0; i < count; i++)
+				processors_.push_back({ i, i, 0, 0, 0 });
+		}
+	}
+
+	void CpuTopology::Detect(){
+		// OS ids of the cores and nodes (which may have gaps) are renumbered from 0
+		std::map<std::pair<int, int>, int> cores;		// (package, core id) -> core
+		std::map<int, int> nodes;
+		std::vector<int> core_threads;
+		auto add = [&](int cpu, int package, int core_id, int node_id){
+			auto core = cores.emplace(std::make_pair(package, core_id), int(cores.size())).first->second;
+			auto node = nodes.emplace(node_id, int(nodes.size())).first->second;
+			if (core >= int(core_threads.size()))
+				core_threads.resize(core + 1, 0);
+			processors_.push_back({ cpu, core, core_threads[core]++, package, node });
+		};
+
+#if defined(__linux__)
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+			return;
+		std::map<int, int> cpu_nodes;
+		if (DIR *dir = opendir("/sys/devices/system/node")){
+			while (dirent *entry = readdir(dir)){
+				int node;
+				if (std::sscanf(entry->d_name, "node%d", &node) != 1)
+					continue;
+				for (int cpu : ReadSysCpuList("/sys/devices/system/node/" + std::string(entry->d_name) + "/cpulist"))
+					cpu_nodes[cpu] = node;
+			}
+			closedir(dir);
+		}
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+			if (!CPU_ISSET(cpu, &allowed))
+				continue;
+			std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+			auto node = cpu_nodes.find(cpu);
+			add(cpu,
+				ReadSysInt(topology + "physical_package_id", 0),
+				ReadSysInt(topology + "core_id", cpu),
+				node == cpu_nodes.end() ? 0 : node->second);
+		}
+#elif defined(_WIN32)
+		DWORD_PTR process_mask, system_mask;
+		if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+			return;
+		for (int cpu = 0; cpu < int(sizeof(DWORD_PTR) * 8); cpu++){
+			if (!(process_mask & (DWORD_PTR(1) << cpu)))
+				continue;
+			UCHAR node = 0;
+			GetNumaProcessorNode(UCHAR(cpu), &node);
+			add(cpu, 0, cpu, node);
+		}
+#endif
+		node_count_ = Math::Max(1, int(nodes.size()));
+	}
+
+	const CpuTopology::Processor *CpuTopology::Find(int cpu) const {
+		for (auto& processor : processors_){
+			if (processor.cpu == cpu)
+				return &processor;
+		}
+		return nullptr;
+	}
+
+	std::vector<int> CpuTopology::NodeProcessors(int node) const {
+		std::vector<const Processor *> members;
+		for (auto& processor : processors_){
+			if (processor.node == node)
+				members.push_back(&processor);
+		}
+		std::stable_sort(members.begin(), members.end(), [](const Processor *a, const Processor *b){
+			return a->thread < b->thread;
+		});
+		std::vector<int> cpus;
+		for (auto processor : members)
+			cpus.push_back(processor->cpu);
+		return cpus;
+	}
+
+	std::vector<int> CpuTopology::PlacementOrder(bool interleave_nodes) const {
+		std::vector<std::vector<int>> nodes;
+		for (int node = 0; node < node_count_; node++)
+			nodes.push_back(NodeProcessors(node));
+		std::vector<int> order;
+		if (!interleave_nodes){
+			for (auto& cpus : nodes)
+				order.insert(order.end(), cpus.begin(), cpus.end());
+			return order;
+		}
+		for (size_t i = 0; order.size() < processors_.size(); i++){
+			for (auto& cpus : nodes){
+				if (i < cpus.size())
+					order.push_back(cpus[i]);
+			}
+		}
+		return order;
+	}
+
+	bool CpuTopology::PinThread(int cpu){
+		return PinThread(std::vector<int>(1, cpu));
+	}
+
+	bool CpuTopology::PinThread(const std::vector<int>& cpus){
+		if (cpus.empty())
+			return false;
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int cpu : cpus){
+			if (cpu >= 0 && cpu < CPU_SETSIZE)
+				CPU_SET(cpu, &set);
+		}
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+		DWORD_PTR mask = 0;
+		for (int cpu : cpus){
+			if (cpu >= 0 && cpu < int(sizeof(DWORD_PTR) * 8))
+				mask |= DWORD_PTR(1) << cpu;
+		}
+		return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+		return false;
+#endif
+	}
+}
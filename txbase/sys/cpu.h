@@ -0,0 +1,99 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include <vector>
+
+namespace TX
+{
+	/// <summary>
+	/// Instruction set levels the dispatched kernels are compiled for, in increasing order.
+	/// </summary>
+	enum class SimdLevel {
+		SSE41,		// baseline of the build
+		AVX2,		// AVX2 and FMA
+		AVX512		// AVX-512 F
+	};
+
+	/// <summary>
+	/// Instruction set extensions of the processor, usable only if the OS also saves the wider registers.
+	/// </summary>
+	class CpuFeatures {
+	public:
+		bool sse41 = false;
+		bool avx = false;
+		bool avx2 = false;
+		bool fma = false;
+		bool avx512f = false;
+	public:
+		/// <summary>
+		/// Detected once, on first use.
+		/// </summary>
+		static const CpuFeatures& Get();
+
+		inline bool Supports(SimdLevel level) const {
+			switch (level){
+			case SimdLevel::AVX512: return avx512f && avx2 && fma;
+			case SimdLevel::AVX2: return avx2 && fma;
+			default: return sse41;
+			}
+		}
+		/// <summary>
+		/// The highest level supported, the environment variable TX_SIMD_LEVEL (sse41, avx2 or avx512) can lower it.
+		/// </summary>
+		SimdLevel Level() const;
+	private:
+		CpuFeatures();
+		void Detect();
+	};
+
+	/// <summary>
+	/// Logical processors available to the process, with the core, package and NUMA node they belong to.
+	/// </summary>
+	class CpuTopology {
+	public:
+		struct Processor {
+			int cpu;		// OS index of the logical processor
+			int core;		// physical core, shared by SMT siblings
+			int thread;		// index among the SMT siblings of the core
+			int package;	// socket
+			int node;		// NUMA node
+		};
+	public:
+		/// <summary>
+		/// Detected once, on first use.
+		/// </summary>
+		static const CpuTopology& Get();
+
+		inline int ProcessorCount() const { return int(processors_.size()); }
+		inline const Processor& operator [] (int i) const { return processors_[i]; }
+		inline int NodeCount() const { return node_count_; }
+		/// <summary>
+		/// The processor with the given OS index, or null if the process can't run on it.
+		/// </summary>
+		const Processor *Find(int cpu) const;
+		/// <summary>
+		/// OS indices of the logical processors of a NUMA node, the first SMT thread of every core before the siblings.
+		/// </summary>
+		std::vector<int> NodeProcessors(int node) const;
+		/// <summary>
+		/// Order in which to place threads: the first SMT thread of every core before the siblings,
+		/// either filling one NUMA node after another, or alternating between the nodes.
+		/// </summary>
+		std::vector<int> PlacementOrder(bool interleave_nodes) const;
+
+		/// <summary>
+		/// Pins the calling thread to one logical processor (by OS index). Returns false if unsupported.
+		/// </summary>
+		static bool PinThread(int cpu);
+		/// <summary>
+		/// Restricts the calling thread to a set of logical processors. Returns false if unsupported.
+		/// </summary>
+		static bool PinThread(const std::vector<int>& cpus);
+	private:
+		CpuTopology();
+		void Detect();
+	private:
+		std::vector<Processor> processors_;
+		int node_count_;
+	};
+}
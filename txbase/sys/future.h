@@ -0,0 +1,326 @@
+#pragma once
+
+#include "txbase/sys/thread.h"
+#include <exception>
+#include <functional>
+#include <future>
+
+namespace TX
+{
+	template<typename T> class Future;
+	template<typename T> class Promise;
+
+	/// <summary>
+	/// How a result type is stored and handed to continuations, void results are stored as an empty struct.
+	/// </summary>
+	template<typename T>
+	struct FutureTraits {
+		typedef T Stored;
+		typedef const T& Result;
+		typedef std::vector<T> All;
+		static inline const T& Get(const Stored& value) { return value; }
+		template<typename F>
+		static inline auto Call(F& func, const Stored& value) -> decltype(func(value)) { return func(value); }
+		static All Collect(const std::vector<Future<T>>& futures);
+	};
+	template<>
+	struct FutureTraits<void> {
+		struct Stored {};
+		typedef void Result;
+		typedef void All;
+		static inline void Get(const Stored&) {}
+		template<typename F>
+		static inline auto Call(F& func, const Stored&) -> decltype(func()) { return func(); }
+		static inline Stored Collect(const std::vector<Future<void>>&) { return Stored(); }
+	};
+
+	/// <summary>
+	/// Shared by a Promise and its Futures: the value or the exception, and the callbacks to run once either is set.
+	/// </summary>
+	template<typename T>
+	class FutureState : NonCopyable {
+	public:
+		typedef typename FutureTraits<T>::Stored Stored;
+		typedef std::function<void()> Callback;
+
+		FutureState(TaskScheduler *scheduler) : scheduler_(scheduler), ready_(false), has_value_(false) {}
+		~FutureState() { if (has_value_) ((Stored *)storage_)->~Stored(); }
+
+		inline TaskScheduler *Scheduler() const { return scheduler_; }
+		inline bool Ready() const { return ready_.load(std::memory_order_acquire); }
+		inline bool Failed() const { return bool(error_); }
+		inline std::exception_ptr Error() const { return error_; }
+		inline const Stored& Value() const { assert(has_value_); return *(const Stored *)storage_; }
+		inline void Rethrow() const { if (error_) std::rethrow_exception(error_); }
+
+		void SetValue(Stored&& value) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			assert(!ready_ && "the promise is already fulfilled");
+			new (storage_) Stored(std::move(value));
+			has_value_ = true;
+			Complete(lock);
+		}
+		void SetException(std::exception_ptr error) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			assert(!ready_ && "the promise is already fulfilled");
+			error_ = error;
+			Complete(lock);
+		}
+		/// <summary>
+		/// Fails with std::future_errc::broken_promise unless already fulfilled.
+		/// </summary>
+		void Abandon() {
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (ready_)
+				return;
+			error_ = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+			Complete(lock);
+		}
+		/// <summary>
+		/// Runs the callback on the thread that fulfills the promise, or right away if it already is.
+		/// </summary>
+		void OnReady(Callback callback) {
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				if (!ready_){
+					callbacks_.push_back(std::move(callback));
+					return;
+				}
+			}
+			callback();
+		}
+		/// <summary>
+		/// Runs queued tasks while waiting like TaskGroup::Wait(), then blocks.
+		/// </summary>
+		void Wait() {
+			bool worker = scheduler_->IsWorkerThread();
+			while (!Ready()){
+				if (scheduler_->TryRunTask())
+					continue;
+				if (!worker)
+					break;
+				std::this_thread::yield();
+			}
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (!ready_){
+				ready_cv_.wait(lock);
+			}
+		}
+	private:
+		void Complete(std::unique_lock<std::mutex>& lock) {
+			ready_.store(true, std::memory_order_release);
+			std::vector<Callback> callbacks;
+			callbacks.swap(callbacks_);
+			ready_cv_.notify_all();
+			lock.unlock();
+			for (auto& callback : callbacks)
+				callback();
+		}
+	private:
+		TaskScheduler *scheduler_;
+		std::atomic_bool ready_;
+		bool has_value_;
+		alignas(Stored) unsigned char storage_[sizeof(Stored)];
+		std::exception_ptr error_;
+		std::vector<Callback> callbacks_;
+		std::mutex mutex_;
+		std::condition_variable ready_cv_;
+	};
+
+	/// <summary>
+	/// The producing end: fulfilled exactly once, with a value or an exception.
+	/// Copies refer to the same result. If the last copy is destroyed unfulfilled, the futures
+	/// fail with std::future_error (std::future_errc::broken_promise) instead of waiting forever.
+	/// </summary>
+	template<typename T>
+	class Promise {
+	public:
+		typedef typename FutureTraits<T>::Stored Stored;
+
+		Promise(TaskScheduler *scheduler = TaskScheduler::Instance()) : producer_(std::make_shared<Producer>(scheduler)) {}
+		inline Future<T> GetFuture() const { return Future<T>(producer_->state); }
+		inline void SetValue(Stored value) const { producer_->state->SetValue(std::move(value)); }
+		inline void SetValue() const { producer_->state->SetValue(Stored()); }
+		inline void SetException(std::exception_ptr error) const { producer_->state->SetException(error); }
+	private:
+		/// <summary>
+		/// Owned by the copies of a promise only, the futures keep the state alive on their own.
+		/// </summary>
+		struct Producer : NonCopyable {
+			Producer(TaskScheduler *scheduler) : state(std::make_shared<FutureState<T>>(scheduler)) {}
+			~Producer() { state->Abandon(); }
+			std::shared_ptr<FutureState<T>> state;
+		};
+		std::shared_ptr<Producer> producer_;
+	};
+
+	/// <summary>
+	/// Calls func and fulfills the promise with its result, or with the exception it throws.
+	/// </summary>
+	template<typename R>
+	struct FutureFulfill {
+		template<typename F>
+		static void Run(const Promise<R>& promise, F& func) {
+			try { promise.SetValue(func()); }
+			catch (...) { promise.SetException(std::current_exception()); }
+		}
+	};
+	template<>
+	struct FutureFulfill<void> {
+		template<typename F>
+		static void Run(const Promise<void>& promise, F& func) {
+			try { func(); }
+			catch (...) { promise.SetException(std::current_exception()); return; }
+			promise.SetValue();
+		}
+	};
+
+	/// <summary>
+	/// The consuming end of an asynchronous result. Copies refer to the same result.
+	/// </summary>
+	template<typename T>
+	class Future {
+	private:
+		typedef typename FutureTraits<T>::Stored Stored;
+		template<typename F>
+		using ThenResult = decltype(FutureTraits<T>::Call(std::declval<F&>(), std::declval<const Stored&>()));
+	public:
+		Future() {}
+
+		inline bool Valid() const { return bool(state_); }
+		inline bool Ready() const { return state_->Ready(); }
+		/// <summary>
+		/// Waits for the result, running queued tasks in the meantime.
+		/// </summary>
+		inline void Wait() const { state_->Wait(); }
+		/// <summary>
+		/// Waits for the result, then returns it, or throws the exception the producer failed with.
+		/// </summary>
+		inline typename FutureTraits<T>::Result Get() const {
+			Wait();
+			state_->Rethrow();
+			return FutureTraits<T>::Get(state_->Value());
+		}
+
+		/// <summary>
+		/// Queues func(value) (or func() for Future&lt;void&gt;) on the scheduler once the result is ready,
+		/// and returns the future of what it returns. If this future fails, func is skipped and the result
+		/// fails with the same exception.
+		/// </summary>
+		template<typename F>
+		Future<ThenResult<F>> Then(F func, TaskScheduler::Priority priority = TaskScheduler::Priority::Inherit) const {
+			typedef ThenResult<F> R;
+			assert(Valid());
+			TaskScheduler *scheduler = state_->Scheduler();
+			// the priority of the thread adding the continuation, not of the one fulfilling the promise
+			if (priority == TaskScheduler::Priority::Inherit)
+				priority = scheduler->CurrentPriority();
+			Promise<R> promise(scheduler);
+			std::shared_ptr<FutureState<T>> state = state_;
+			state_->OnReady([scheduler, priority, state, promise, func]() {
+				scheduler->AddTask(TaskScheduler::Task([state, promise, func]() mutable {
+					if (state->Failed()){
+						promise.SetException(state->Error());
+						return;
+					}
+					auto call = [&]() { return FutureTraits<T>::Call(func, state->Value()); };
+					FutureFulfill<R>::Run(promise, call);
+				}), priority);
+			});
+			return promise.GetFuture();
+		}
+
+	private:
+		template<typename> friend class Promise;
+		template<typename> friend struct FutureTraits;
+		template<typename U> friend Future<typename FutureTraits<U>::All> WhenAll(const std::vector<Future<U>>& futures);
+		template<typename U> friend Future<size_t> WhenAny(const std::vector<Future<U>>& futures);
+		Future(const std::shared_ptr<FutureState<T>>& state) : state_(state) {}
+	private:
+		std::shared_ptr<FutureState<T>> state_;
+	};
+
+	template<typename T>
+	typename FutureTraits<T>::All FutureTraits<T>::Collect(const std::vector<Future<T>>& futures) {
+		All values;
+		values.reserve(futures.size());
+		for (auto& future : futures)
+			values.push_back(future.state_->Value());
+		return values;
+	}
+
+	/// <summary>
+	/// Runs func on the scheduler and returns the future of its result.
+	/// </summary>
+	template<typename F>
+	Future<decltype(std::declval<F&>()())> Async(F func,
+		TaskScheduler::Priority priority = TaskScheduler::Priority::Inherit,
+		TaskScheduler *scheduler = TaskScheduler::Instance())
+	{
+		typedef decltype(func()) R;
+		Promise<R> promise(scheduler);
+		scheduler->AddTask(TaskScheduler::Task([promise, func]() mutable {
+			FutureFulfill<R>::Run(promise, func);
+		}), priority);
+		return promise.GetFuture();
+	}
+
+	/// <summary>
+	/// Ready once all the futures are: with their values in order (nothing for void futures),
+	/// or with the exception of the first failed one in order.
+	/// </summary>
+	template<typename T>
+	Future<typename FutureTraits<T>::All> WhenAll(const std::vector<Future<T>>& futures) {
+		typedef typename FutureTraits<T>::All All;
+		struct Join {
+			Join(const std::vector<Future<T>>& futures, TaskScheduler *scheduler) :
+				futures(futures), promise(scheduler), remaining(int(futures.size())) {}
+			std::vector<Future<T>> futures;
+			Promise<All> promise;
+			std::atomic_int remaining;
+			void Complete() {
+				for (auto& future : futures){
+					if (future.state_->Failed()){
+						promise.SetException(future.state_->Error());
+						return;
+					}
+				}
+				promise.SetValue(FutureTraits<T>::Collect(futures));
+			}
+		};
+		auto join = std::make_shared<Join>(futures, futures.empty() ? TaskScheduler::Instance() : futures[0].state_->Scheduler());
+		Future<All> result = join->promise.GetFuture();
+		if (futures.empty()){
+			join->Complete();
+			return result;
+		}
+		for (auto& future : futures){
+			future.state_->OnReady([join]() {
+				if (--join->remaining == 0)
+					join->Complete();
+			});
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Ready once any of the futures is, with the index of the first one. The futures must not be empty.
+	/// </summary>
+	template<typename T>
+	Future<size_t> WhenAny(const std::vector<Future<T>>& futures) {
+		assert(!futures.empty());
+		struct Race {
+			Race(TaskScheduler *scheduler) : promise(scheduler), done(false) {}
+			Promise<size_t> promise;
+			std::atomic_bool done;
+		};
+		auto race = std::make_shared<Race>(futures[0].state_->Scheduler());
+		for (size_t i = 0; i < futures.size(); i++){
+			futures[i].state_->OnReady([race, i]() {
+				if (!race->done.exchange(true))
+					race->promise.SetValue(i);
+			});
+		}
+		return race->promise.GetFuture();
+	}
+}
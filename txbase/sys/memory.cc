@@ -0,0 +1,153 @@
+#include "txbase/stdafx.h"
+#include "memory.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace TX
+{
+	namespace {
+		struct Mapping {
+			void *base;			// of the whole mapping, which may start before the pointer handed out
+			size_t size;		// of the whole mapping
+			size_t bytes;		// requested
+			MemoryTag tag;
+			bool huge;			// explicit huge pages
+		};
+
+		struct Mappings {
+			std::mutex mutex;
+			std::unordered_map<void *, Mapping> map;
+			size_t bytes = 0, hugeBytes = 0;
+		};
+		Mappings& GetMappings(){
+			static Mappings *mappings = new Mappings;		// outlives static objects freeing memory at exit
+			return *mappings;
+		}
+
+		std::atomic<size_t> large_alloc_threshold(size_t(2) << 20);
+		std::atomic_bool huge_pages_failed(false);		// no explicit huge pages reserved, don't ask every time
+
+		inline size_t RoundUp(size_t size, size_t alignment){ return (size + alignment - 1) & ~(alignment - 1); }
+
+		/// <summary>
+		/// Maps the pages, returns the pointer to hand out or null.
+		/// </summary>
+		void *MapPages(size_t bytes, Mapping& mapping){
+#if defined(__linux__)
+			const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+			size_t size = RoundUp(bytes, HUGE_PAGE_SIZE);
+			if (!huge_pages_failed.load(std::memory_order_relaxed)){
+				void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				if (ptr != MAP_FAILED){
+					mapping = { ptr, size, bytes, MemoryTag::General, true };
+					return ptr;
+				}
+				huge_pages_failed = true;
+			}
+			// transparent huge pages only back whole aligned huge pages, so map some slack and trim it
+			size_t span = size + HUGE_PAGE_SIZE;
+			char *raw = (char *)mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (raw == (char *)MAP_FAILED)
+				return nullptr;
+			char *ptr = (char *)RoundUp(uintptr_t(raw), HUGE_PAGE_SIZE);
+			if (ptr > raw)
+				munmap(raw, ptr - raw);
+			if (raw + span > ptr + size)
+				munmap(ptr + size, raw + span - (ptr + size));
+#ifdef MADV_HUGEPAGE
+			madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+			mapping = { ptr, size, bytes, MemoryTag::General, false };
+			return ptr;
+#elif defined(_WIN32)
+			size_t large_page = GetLargePageMinimum();
+			if (large_page && !huge_pages_failed.load(std::memory_order_relaxed)){
+				// only succeeds if the user holds SeLockMemoryPrivilege
+				size_t size = RoundUp(bytes, large_page);
+				void *ptr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				if (ptr){
+					mapping = { ptr, size, bytes, MemoryTag::General, true };
+					return ptr;
+				}
+				huge_pages_failed = true;
+			}
+			size_t size = RoundUp(bytes, PAGE_ALLOC_ALIGNMENT);
+			void *ptr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (!ptr)
+				return nullptr;
+			mapping = { ptr, size, bytes, MemoryTag::General, false };
+			return ptr;
+#else
+			return nullptr;
+#endif
+		}
+
+		void UnmapPages(const Mapping& mapping){
+#if defined(__linux__)
+			munmap(mapping.base, mapping.size);
+#elif defined(_WIN32)
+			VirtualFree(mapping.base, 0, MEM_RELEASE);
+#endif
+		}
+	}
+
+	void *AllocPages(size_t size, MemoryTag tag){
+		if (!size)
+			return nullptr;
+		Mapping mapping;
+		void *ptr = MapPages(size, mapping);
+		if (!ptr)
+			return nullptr;
+		mapping.tag = tag;
+		Mappings& mappings = GetMappings();
+		{
+			std::unique_lock<std::mutex> lock(mappings.mutex);
+			mappings.map.emplace(ptr, mapping);
+			mappings.bytes += mapping.size;
+			if (mapping.huge)
+				mappings.hugeBytes += mapping.size;
+		}
+		MemoryTracker::Allocated(tag, size);
+		return ptr;
+	}
+
+	bool FreePages(void *ptr){
+		Mappings& mappings = GetMappings();
+		Mapping mapping;
+		{
+			std::unique_lock<std::mutex> lock(mappings.mutex);
+			auto it = mappings.map.find(ptr);
+			if (it == mappings.map.end())
+				return false;
+			mapping = it->second;
+			mappings.map.erase(it);
+			mappings.bytes -= mapping.size;
+			if (mapping.huge)
+				mappings.hugeBytes -= mapping.size;
+		}
+		MemoryTracker::Freed(mapping.tag, mapping.bytes);
+		UnmapPages(mapping);
+		return true;
+	}
+
+	PageAllocStats GetPageAllocStats(){
+		Mappings& mappings = GetMappings();
+		std::unique_lock<std::mutex> lock(mappings.mutex);
+		return{ mappings.map.size(), mappings.bytes, mappings.hugeBytes };
+	}
+
+	void SetLargeAllocThreshold(size_t bytes){
+		large_alloc_threshold = bytes;
+	}
+
+	size_t LargeAllocThreshold(){
+		return large_alloc_threshold.load(std::memory_order_relaxed);
+	}
+}
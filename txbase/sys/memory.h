@@ -2,7 +2,14 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <cassert>
+#include <new>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include <mutex>
 #include "txbase/math/base.h"
+#include "txbase/sys/memtrack.h"
 
 namespace TX
 {
@@ -57,14 +64,80 @@ namespace TX
 			std::memset(ptr, 0, sizeof(T) * count);
 	}
 
+	/// <summary>
+	/// Memory mapped directly from the OS for large buffers, backed by huge pages where possible to cut TLB misses:
+	/// explicit huge pages (MAP_HUGETLB, or MEM_LARGE_PAGES on Windows) if any are reserved, otherwise transparent
+	/// huge pages requested with madvise. Returns null if the platform has no such mapping, so callers can
+	/// fall back to the heap. The memory is zeroed and aligned to at least PAGE_ALLOC_ALIGNMENT.
+	/// </summary>
+	void *AllocPages(size_t size, MemoryTag tag = MemoryTag::General);
+	/// <summary>
+	/// Releases memory from AllocPages(), returns false (and does nothing) for any other pointer.
+	/// </summary>
+	bool FreePages(void *ptr);
+	static const size_t PAGE_ALLOC_ALIGNMENT = 65536;
+
+	struct PageAllocStats {
+		size_t allocations;		// live mappings
+		size_t bytes;			// mapped for them
+		size_t hugeBytes;		// of which explicit huge pages, the rest may get transparent ones
+	};
+	PageAllocStats GetPageAllocStats();
+	/// <summary>
+	/// AllocAligned() maps requests of at least this many bytes with AllocPages(), 2 MiB by default.
+	/// SIZE_MAX disables it.
+	/// </summary>
+	void SetLargeAllocThreshold(size_t bytes);
+	size_t LargeAllocThreshold();
+
+#ifdef TX_MEMORY_TRACKING
+	namespace Internal {
+		/// <summary>
+		/// Stored right before tracked aligned allocations, so that they can be accounted when freed.
+		/// </summary>
+		struct AllocHeader {
+			size_t size;
+			uint32_t offset;		// from the start of the underlying allocation
+			MemoryTag tag;
+		};
+		static_assert(sizeof(AllocHeader) <= 16, "the header has to fit in the minimum alignment");
+	}
+#endif
+
+	/// <summary>
+	/// Uninitialized room for count objects, accounted to the tag when memory tracking is enabled.
+	/// Requests from LargeAllocThreshold() on are mapped with AllocPages() if possible. Must be released by FreeAligned().
+	/// </summary>
 	template <typename T>
-	inline T* AllocAligned(uint32_t count, size_t alignment = 64) {
+	inline T* AllocAligned(uint32_t count, size_t alignment = 64, MemoryTag tag = MemoryTag::General) {
 		void* memptr;
+		size_t size = count * sizeof(T);
+		if (size >= LargeAllocThreshold() && alignment <= PAGE_ALLOC_ALIGNMENT) {
+			if ((memptr = AllocPages(size, tag)))
+				return (T *)memptr;
+		}
+#ifdef TX_MEMORY_TRACKING
+		alignment = Math::Max(alignment, size_t(16));
+		size_t offset = alignment;
+		size += offset;
+#endif
 
 #ifdef _MSC_VER
-		memptr = _aligned_malloc(count * sizeof(T), alignment);
+		memptr = _aligned_malloc(size, alignment);
 #else
-		posix_memalign(&memptr, alignment, count * sizeof(T));
+		if (posix_memalign(&memptr, alignment, size) != 0)
+			memptr = nullptr;
+#endif
+
+#ifdef TX_MEMORY_TRACKING
+		if (!memptr)
+			return nullptr;
+		memptr = (char *)memptr + offset;
+		Internal::AllocHeader *header = (Internal::AllocHeader *)memptr - 1;
+		header->size = size - offset;
+		header->offset = uint32_t(offset);
+		header->tag = tag;
+		MemoryTracker::Allocated(tag, header->size);
 #endif
 		return (T *)memptr;
 	}
@@ -72,61 +145,435 @@ namespace TX
 	template <typename T>
 	inline void FreeAligned(T*& ptr) {
 		if (ptr) {
+			void *memptr = (void *)ptr;
+			ptr = nullptr;
+			// heap blocks are rarely aligned this much, which saves looking up the mappings for most of them
+			if ((uintptr_t(memptr) & (PAGE_ALLOC_ALIGNMENT - 1)) == 0 && FreePages(memptr))
+				return;
+#ifdef TX_MEMORY_TRACKING
+			Internal::AllocHeader *header = (Internal::AllocHeader *)memptr - 1;
+			MemoryTracker::Freed(header->tag, header->size);
+			memptr = (char *)memptr - header->offset;
+#endif
 #ifdef _MSC_VER
-			_aligned_free(ptr);
+			_aligned_free(memptr);
 #else
-			free(ptr);
+			free(memptr);
 #endif
-			ptr = nullptr;
 		}
 	}
 
+	/// <summary>
+	/// Deleter of unique_ptr for memory from AllocAligned(). Doesn't run destructors.
+	/// </summary>
+	struct AlignedDeleter {
+		template<typename T>
+		inline void operator () (T *ptr) const { FreeAligned(ptr); }
+	};
+
 
-	class MemoryArena {
+	/// <summary>
+	/// Bump allocator over fixed-size blocks. Allocations are only released all at once, either by FreeAll()
+	/// or by rewinding to a mark taken earlier. Requests larger than a block get a block of their own,
+	/// which is freed (rather than kept for reuse) when rewound past.
+	/// </summary>
+	class MemoryArena : NonCopyable {
 	private:
-		uint32_t currBlockPos, blockSize;
-		char *currBlock;
-		std::vector<char *> used, available;
+		struct Block {
+			char *data;
+			size_t size;
+			bool dedicated;		// holds a single large allocation
+		};
 	public:
-		MemoryArena(uint32_t blockSize = 32768) :
+		/// <summary>
+		/// The state of the arena at some point, see Rewind().
+		/// </summary>
+		struct Marker {
+			size_t usedCount;
+			size_t blockPos;
+			size_t bytesUsed;
+		};
+		static const size_t MIN_ALIGNMENT = 16;
+	private:
+		size_t currBlockPos, blockSize;
+		Block currBlock;
+		std::vector<Block> used, available;
+		size_t bytesUsed, peakBytesUsed, bytesReserved;
+		MemoryTag tag;
+	public:
+		/// <summary>
+		/// The blocks are accounted to the tag when memory tracking is enabled.
+		/// </summary>
+		MemoryArena(uint32_t blockSize = 32768, MemoryTag tag = MemoryTag::Arena) :
 			currBlockPos(0),
-			blockSize(blockSize){
-			currBlock = AllocAligned<char>(blockSize);
+			blockSize(blockSize),
+			bytesUsed(0),
+			peakBytesUsed(0),
+			bytesReserved(0),
+			tag(tag){
+			currBlock = NewBlock(blockSize, 64);
 		}
 		~MemoryArena() {
-			FreeAligned(currBlock);
+			FreeBlock(currBlock);
 			for (size_t i = 0; i < used.size(); i++)
-				FreeAligned(used[i]);
-			for (size_t i = 0; i < available.size(); i++)
-				FreeAligned(available[i]);
+				FreeBlock(used[i]);
+			Trim();
 		}
 
+		/// <summary>
+		/// Uninitialized room for count objects, aligned to alignof(T) and at least 16 bytes.
+		/// </summary>
 		template <typename T>
 		inline T* Alloc(uint32_t count = 1) {
-			size_t size = sizeof(T) * count;
-			size = ((size + 15) & (~15));							// round up to 16 bytes alignment
-			if (currBlockPos + size > blockSize) {					// if current block doesn't have enough room
-				used.push_back(currBlock);					//	 mark current block as used
-				if (available.size() && size <= blockSize) {	// take one from available (if there is any block)
+			return (T *)Alloc(sizeof(T) * count, alignof(T));
+		}
+		void *Alloc(size_t size, size_t alignment) {
+			alignment = Math::Max(alignment, MIN_ALIGNMENT);
+			size = (size + MIN_ALIGNMENT - 1) & ~(MIN_ALIGNMENT - 1);
+			bytesUsed += size;
+			peakBytesUsed = Math::Max(peakBytesUsed, bytesUsed);
+			if (size + alignment - MIN_ALIGNMENT > blockSize) {		// too large for any block, give it one of its own
+				Block block = NewBlock(size, Math::Max(alignment, size_t(64)));
+				block.dedicated = true;
+				used.push_back(block);
+				return block.data;
+			}
+			size_t pos = AlignedPos(alignment);
+			if (pos + size > blockSize) {							// if current block doesn't have enough room
+				used.push_back(currBlock);							//	 mark current block as used
+				if (available.size()) {								// take one from available (if there is any block)
 					currBlock = available.back();
 					available.pop_back();
 				}
 				else {												// allocate a new block
-					currBlock = AllocAligned<char>(Math::Max(size, blockSize));
+					currBlock = NewBlock(blockSize, 64);
 				}
 				currBlockPos = 0;
+				pos = AlignedPos(alignment);
 			}
-			T *ret = (T *)(currBlock + currBlockPos);
-			currBlockPos += size;									// update the pointer to next allocation
-			return ret;
+			currBlockPos = pos + size;								// update the pointer to next allocation
+			return currBlock.data + pos;
 		}
-		void FreeAll() {
-			// mark all blocks as available
-			currBlockPos = 0;
-			while (used.size()) {
-				available.push_back(used.back());
+
+		/// <summary>
+		/// The current state, which Rewind() returns to.
+		/// </summary>
+		inline Marker Mark() const { return{ used.size(), currBlockPos, bytesUsed }; }
+		/// <summary>
+		/// Releases everything allocated since the mark was taken. Marks taken after it become invalid.
+		/// </summary>
+		void Rewind(const Marker& mark) {
+			assert(mark.usedCount <= used.size());
+			while (used.size() > mark.usedCount) {
+				Block block = used.back();
 				used.pop_back();
+				if (block.dedicated)
+					FreeBlock(block);								// reclaim blocks of large allocations right away
+				else {
+					available.push_back(currBlock);
+					currBlock = block;
+				}
+			}
+			currBlockPos = mark.blockPos;
+			bytesUsed = mark.bytesUsed;
+		}
+		void FreeAll() {
+			Rewind(Marker{ 0, 0, 0 });
+		}
+		/// <summary>
+		/// Frees the blocks that aren't in use, e.g. after an unusually heavy frame.
+		/// </summary>
+		void Trim() {
+			for (size_t i = 0; i < available.size(); i++)
+				FreeBlock(available[i]);
+			available.clear();
+		}
+
+		/// <summary>
+		/// Bytes handed out since the last FreeAll(), rounded like the allocations.
+		/// </summary>
+		inline size_t BytesUsed() const { return bytesUsed; }
+		inline size_t PeakBytesUsed() const { return peakBytesUsed; }
+		/// <summary>
+		/// Bytes of the blocks owned by the arena.
+		/// </summary>
+		inline size_t BytesReserved() const { return bytesReserved; }
+	private:
+		inline size_t AlignedPos(size_t alignment) const {
+			uintptr_t address = uintptr_t(currBlock.data + currBlockPos);
+			return currBlockPos + (((address + alignment - 1) & ~uintptr_t(alignment - 1)) - address);
+		}
+		inline Block NewBlock(size_t size, size_t alignment) {
+			Block block = { AllocAligned<char>(uint32_t(size), alignment, tag), size, false };
+			if (!block.data) throw std::bad_alloc();
+			bytesReserved += size;
+			return block;
+		}
+		inline void FreeBlock(Block& block) {
+			bytesReserved -= block.size;
+			FreeAligned(block.data);
+		}
+	};
+
+	/// <summary>
+	/// Standard allocator drawing from a MemoryArena, or from the heap without one. Memory handed back to the arena
+	/// is only reclaimed when the arena is freed or rewound, and a container must release its storage before that
+	/// (clear() keeps it), see ResetArenaVector().
+	/// </summary>
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		typedef T value_type;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		ArenaAllocator(MemoryArena *arena = nullptr) noexcept : arena_(arena) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.Arena()) {}
+
+		inline T *allocate(size_t count) {
+			if (arena_)
+				return (T *)arena_->Alloc(count * sizeof(T), alignof(T));
+			return (T *)::operator new(count * sizeof(T));
+		}
+		inline void deallocate(T *ptr, size_t) noexcept {
+			if (!arena_)
+				::operator delete(ptr);
+		}
+		inline MemoryArena *Arena() const { return arena_; }
+	private:
+		MemoryArena *arena_;
+	};
+	template<typename T, typename U>
+	inline bool operator == (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.Arena() == b.Arena(); }
+	template<typename T, typename U>
+	inline bool operator != (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.Arena() != b.Arena(); }
+
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+	/// <summary>
+	/// Drops the elements and the storage of the vector, which then allocates from the arena (or the heap if null).
+	/// The old storage isn't touched if the elements are trivially destructible, so it may belong to an arena
+	/// that was already freed.
+	/// </summary>
+	template<typename T>
+	inline void ResetArenaVector(ArenaVector<T>& vector, MemoryArena *arena) {
+		ArenaVector<T>(ArenaAllocator<T>(arena)).swap(vector);
+	}
+
+	/// <summary>
+	/// Rewinds the arena to where it was when the scope was entered.
+	/// </summary>
+	class ArenaScope : NonCopyable {
+	public:
+		ArenaScope(MemoryArena& arena) : arena_(arena), mark_(arena.Mark()) {}
+		~ArenaScope() { arena_.Rewind(mark_); }
+		inline MemoryArena& Arena() { return arena_; }
+	private:
+		MemoryArena& arena_;
+		MemoryArena::Marker mark_;
+	};
+
+	/// <summary>
+	/// Fixed-size blocks carved from cache-line aligned slabs, allocated and freed in constant time through
+	/// a free list. Not thread-safe. Slabs are only released when the pool is destroyed.
+	/// </summary>
+	class BlockPool : NonCopyable {
+	private:
+		struct Block { Block *next; };
+	public:
+		static const size_t SLAB_ALIGNMENT = 64;
+
+		/// <summary>
+		/// Blocks are rounded up to a multiple of the alignment, which is at most SLAB_ALIGNMENT.
+		/// </summary>
+		BlockPool(size_t blockSize, size_t alignment = alignof(void *), size_t slabBlocks = 64) :
+			blockSize_(RoundUp(Math::Max(blockSize, sizeof(Block)), Math::Max(alignment, alignof(Block)))),
+			slabBlocks_(Math::Max(slabBlocks, size_t(1))),
+			free_(nullptr),
+			blocksUsed_(0) {
+			assert(alignment <= SLAB_ALIGNMENT && (alignment & (alignment - 1)) == 0);
+		}
+		~BlockPool() {
+			for (size_t i = 0; i < slabs_.size(); i++)
+				FreeAligned(slabs_[i]);
+		}
+
+		inline void *Alloc() {
+			if (!free_)
+				Grow();
+			Block *block = free_;
+			free_ = block->next;
+			blocksUsed_++;
+			return block;
+		}
+		inline void Free(void *ptr) {
+			if (!ptr) return;
+			Block *block = (Block *)ptr;
+			block->next = free_;
+			free_ = block;
+			blocksUsed_--;
+		}
+
+		inline size_t BlockSize() const { return blockSize_; }
+		inline size_t BlocksUsed() const { return blocksUsed_; }
+		inline size_t BlocksReserved() const { return slabs_.size() * slabBlocks_; }
+	private:
+		static inline size_t RoundUp(size_t size, size_t alignment) { return (size + alignment - 1) & ~(alignment - 1); }
+		void Grow() {
+			char *slab = AllocAligned<char>(uint32_t(blockSize_ * slabBlocks_), SLAB_ALIGNMENT);
+			if (!slab) throw std::bad_alloc();
+			slabs_.push_back(slab);
+			for (size_t i = slabBlocks_; i-- > 0;) {				// in address order
+				Block *block = (Block *)(slab + i * blockSize_);
+				block->next = free_;
+				free_ = block;
 			}
 		}
+	private:
+		size_t blockSize_, slabBlocks_;
+		Block *free_;
+		size_t blocksUsed_;
+		std::vector<char *> slabs_;
+	};
+
+	/// <summary>
+	/// Process-wide pool of BLOCK_SIZE byte blocks, usable from any thread. Every thread keeps its own free list
+	/// and exchanges batches of blocks with a shared list, so blocks freed on another thread come back without
+	/// taking a lock on every call. Blocks are whole cache lines, as they are passed between threads.
+	/// Slabs are never released.
+	/// </summary>
+	template<size_t BLOCK_SIZE>
+	class SharedBlockPool {
+	private:
+		struct Block { Block *next; };
+		struct Batch { Block *head; int count; };
+		static const int BATCH_SIZE = 64;
+		struct Shared {
+			std::mutex mutex;
+			std::vector<Batch> batches;
+		};
+		struct Cache {
+			Block *head = nullptr;
+			int count = 0;
+			~Cache() { if (count) Flush(*this, count); }
+		};
+	public:
+		static inline void *Alloc() {
+			Cache& cache = cache_;
+			if (!cache.head)
+				Refill(cache);
+			Block *block = cache.head;
+			cache.head = block->next;
+			cache.count--;
+			return block;
+		}
+		static inline void Free(void *ptr) {
+			if (!ptr) return;
+			Cache& cache = cache_;
+			Block *block = (Block *)ptr;
+			block->next = cache.head;
+			cache.head = block;
+			if (++cache.count >= 2 * BATCH_SIZE)
+				Flush(cache, BATCH_SIZE);
+		}
+	private:
+		static Shared& SharedList() {
+			static Shared *shared = new Shared;		// outlives the thread caches flushed at exit
+			return *shared;
+		}
+		static void Refill(Cache& cache) {
+			Shared& shared = SharedList();
+			{
+				std::unique_lock<std::mutex> lock(shared.mutex);
+				if (!shared.batches.empty()){
+					cache.head = shared.batches.back().head;
+					cache.count = shared.batches.back().count;
+					shared.batches.pop_back();
+					return;
+				}
+			}
+			char *slab = AllocAligned<char>(BLOCK_SIZE * BATCH_SIZE, 64);
+			if (!slab) throw std::bad_alloc();
+			for (int i = BATCH_SIZE - 1; i >= 0; i--){
+				Block *block = (Block *)(slab + i * BLOCK_SIZE);
+				block->next = cache.head;
+				cache.head = block;
+			}
+			cache.count = BATCH_SIZE;
+		}
+		static void Flush(Cache& cache, int count) {
+			Batch batch = { cache.head, count };
+			Block *last = cache.head;
+			for (int i = 1; i < count; i++)
+				last = last->next;
+			cache.head = last->next;
+			cache.count -= count;
+			last->next = nullptr;
+			Shared& shared = SharedList();
+			std::unique_lock<std::mutex> lock(shared.mutex);
+			shared.batches.push_back(batch);
+		}
+	private:
+		static_assert(BLOCK_SIZE > 0 && BLOCK_SIZE % 64 == 0, "blocks have to stay cache-line aligned");
+		static thread_local Cache cache_;
+	};
+	template<size_t BLOCK_SIZE>
+	thread_local typename SharedBlockPool<BLOCK_SIZE>::Cache SharedBlockPool<BLOCK_SIZE>::cache_;
+
+	/// <summary>
+	/// Pool of objects of type T. By default the pool owns its slabs and must only be used by one thread
+	/// at a time; objects still allocated when it is destroyed aren't destructed. With THREAD_CACHE, objects come
+	/// from the SharedBlockPool of their size through per-thread free lists, and may be freed on any thread.
+	/// </summary>
+	template<typename T, bool THREAD_CACHE = false>
+	class ObjectPool : NonCopyable {
+	public:
+		ObjectPool(size_t slabObjects = 64) : blocks_(sizeof(T), alignof(T), slabObjects) {}
+
+		/// <summary>
+		/// Uninitialized room for one object.
+		/// </summary>
+		inline T *Alloc() { return (T *)blocks_.Alloc(); }
+		inline void Free(T *ptr) { blocks_.Free(ptr); }
+		template<typename... Args>
+		inline T *New(Args&&... args) {
+			void *ptr = blocks_.Alloc();
+			try { return new (ptr) T(std::forward<Args>(args)...); }
+			catch (...) { blocks_.Free(ptr); throw; }
+		}
+		inline void Delete(T *ptr) {
+			if (!ptr) return;
+			ptr->~T();
+			blocks_.Free(ptr);
+		}
+
+		inline size_t Count() const { return blocks_.BlocksUsed(); }
+		inline size_t Capacity() const { return blocks_.BlocksReserved(); }
+	private:
+		BlockPool blocks_;
+	};
+	template<typename T>
+	class ObjectPool<T, true> : NonCopyable {
+	public:
+		static const size_t BLOCK_SIZE = (sizeof(T) + 63) & ~size_t(63);
+		typedef SharedBlockPool<BLOCK_SIZE> Blocks;
+
+		inline T *Alloc() { return (T *)Blocks::Alloc(); }
+		inline void Free(T *ptr) { Blocks::Free(ptr); }
+		template<typename... Args>
+		inline T *New(Args&&... args) {
+			void *ptr = Blocks::Alloc();
+			try { return new (ptr) T(std::forward<Args>(args)...); }
+			catch (...) { Blocks::Free(ptr); throw; }
+		}
+		inline void Delete(T *ptr) {
+			if (!ptr) return;
+			ptr->~T();
+			Blocks::Free(ptr);
+		}
+	private:
+		static_assert(alignof(T) <= 64, "shared pools align objects to cache lines at most");
 	};
 }
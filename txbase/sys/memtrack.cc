@@ -0,0 +1,80 @@
+#include "txbase/stdafx.h"
+#include "memtrack.h"
+
+#include <atomic>
+#include <iomanip>
+
+namespace TX
+{
+#ifdef TX_MEMORY_TRACKING
+	namespace {
+		struct TagCounters {
+			std::atomic<size_t> current, peak, allocations;
+		};
+		TagCounters counters[MEMORY_TAG_COUNT];		// zero-initialized before any dynamic initialization
+	}
+
+	void MemoryTracker::Allocated(MemoryTag tag, size_t bytes){
+		TagCounters& tagCounters = counters[int(tag)];
+		tagCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+		size_t current = tagCounters.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		size_t peak = tagCounters.peak.load(std::memory_order_relaxed);
+		while (peak < current && !tagCounters.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed));
+	}
+
+	void MemoryTracker::Freed(MemoryTag tag, size_t bytes){
+		counters[int(tag)].current.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	MemoryTagStats MemoryTracker::Stats(MemoryTag tag){
+		TagCounters& tagCounters = counters[int(tag)];
+		return{
+			tagCounters.current.load(std::memory_order_relaxed),
+			tagCounters.peak.load(std::memory_order_relaxed),
+			tagCounters.allocations.load(std::memory_order_relaxed) };
+	}
+
+	void MemoryTracker::ResetPeaks(){
+		for (auto& tagCounters : counters)
+			tagCounters.peak.store(tagCounters.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+#else
+	MemoryTagStats MemoryTracker::Stats(MemoryTag){
+		return{ 0, 0, 0 };
+	}
+
+	void MemoryTracker::ResetPeaks(){}
+#endif
+
+	size_t MemoryTracker::TotalBytes(){
+		size_t total = 0;
+		for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++)
+			total += Stats(MemoryTag(tag)).current;
+		return total;
+	}
+
+	void MemoryTracker::Dump(std::ostream& out){
+		if (!ENABLED){
+			out << "memory tracking disabled (build with TX_MEMORY_TRACKING)" << std::endl;
+			return;
+		}
+		std::ios::fmtflags flags = out.flags();
+		out << std::fixed << std::setprecision(2);
+		out << std::left << std::setw(12) << "tag" << std::right
+			<< std::setw(14) << "current MiB" << std::setw(14) << "peak MiB" << std::setw(14) << "allocations" << std::endl;
+		for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++){
+			MemoryTagStats stats = Stats(MemoryTag(tag));
+			out << std::left << std::setw(12) << TagName(MemoryTag(tag)) << std::right
+				<< std::setw(14) << stats.current / 1048576.0
+				<< std::setw(14) << stats.peak / 1048576.0
+				<< std::setw(14) << stats.allocations << std::endl;
+		}
+		out << std::left << std::setw(12) << "total" << std::right << std::setw(14) << TotalBytes() / 1048576.0 << std::endl;
+		out.flags(flags);
+	}
+
+	const char *MemoryTracker::TagName(MemoryTag tag){
+		static const char *names[MEMORY_TAG_COUNT] = { "general", "arena", "scheduler", "mesh", "image", "film", "gui", "gl staging" };
+		return names[int(tag)];
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace TX
+{
+	/// <summary>
+	/// Subsystem an allocation is accounted to.
+	/// </summary>
+	enum class MemoryTag {
+		General,
+		Arena,
+		Scheduler,
+		Mesh,
+		Image,
+		Film,
+		GUI,
+		GLStaging,
+	};
+	static const int MEMORY_TAG_COUNT = int(MemoryTag::GLStaging) + 1;
+
+	struct MemoryTagStats {
+		size_t current;			// bytes live now
+		size_t peak;			// most bytes live at once since the last ResetPeaks()
+		size_t allocations;		// allocations made, including the freed ones
+	};
+
+	/// <summary>
+	/// Live and peak bytes per tag. Only counts while built with TX_MEMORY_TRACKING (the CMake option of the
+	/// same name), otherwise every call compiles to nothing and the stats stay zero.
+	/// </summary>
+	class MemoryTracker {
+	public:
+#ifdef TX_MEMORY_TRACKING
+		static const bool ENABLED = true;
+		static void Allocated(MemoryTag tag, size_t bytes);
+		static void Freed(MemoryTag tag, size_t bytes);
+#else
+		static const bool ENABLED = false;
+		static inline void Allocated(MemoryTag, size_t) {}
+		static inline void Freed(MemoryTag, size_t) {}
+#endif
+		/// <summary>
+		/// A block accounted to the tag was replaced by one of another size.
+		/// </summary>
+		static inline void Resized(MemoryTag tag, size_t oldBytes, size_t newBytes) {
+			if (newBytes == oldBytes) return;
+			if (oldBytes) Freed(tag, oldBytes);
+			if (newBytes) Allocated(tag, newBytes);
+		}
+
+		static MemoryTagStats Stats(MemoryTag tag);
+		static size_t TotalBytes();
+		/// <summary>
+		/// Lowers the peaks to the current counts, e.g. to measure a single frame.
+		/// </summary>
+		static void ResetPeaks();
+		/// <summary>
+		/// Writes a table of the stats of every tag.
+		/// </summary>
+		static void Dump(std::ostream& out);
+		static const char *TagName(MemoryTag tag);
+	};
+
+	/// <summary>
+	/// Bytes held by an object that manages its storage without the tracked allocators,
+	/// released from the tag when destroyed. Empty unless TX_MEMORY_TRACKING is defined.
+	/// </summary>
+	template<MemoryTag TAG>
+	class TrackedBytes {
+#ifdef TX_MEMORY_TRACKING
+	public:
+		TrackedBytes(size_t bytes = 0) : bytes_(0) { Set(bytes); }
+		TrackedBytes(const TrackedBytes& other) : bytes_(0) { Set(other.bytes_); }
+		TrackedBytes(TrackedBytes&& other) : bytes_(other.bytes_) { other.bytes_ = 0; }
+		~TrackedBytes() { Set(0); }
+		inline TrackedBytes& operator = (const TrackedBytes& other) { Set(other.bytes_); return *this; }
+		inline TrackedBytes& operator = (TrackedBytes&& other) {
+			if (this != &other){ Set(0); bytes_ = other.bytes_; other.bytes_ = 0; }
+			return *this;
+		}
+		inline void Set(size_t bytes) { MemoryTracker::Resized(TAG, bytes_, bytes); bytes_ = bytes; }
+		inline size_t Get() const { return bytes_; }
+	private:
+		size_t bytes_;
+#else
+	public:
+		TrackedBytes(size_t = 0) {}
+		inline void Set(size_t) {}
+		inline size_t Get() const { return 0; }
+#endif
+	};
+
+#ifdef TX_MEMORY_TRACKING
+	/// <summary>
+	/// Standard allocator accounting its storage to a tag.
+	/// </summary>
+	template<typename T, MemoryTag TAG>
+	class TrackingAllocator {
+	public:
+		typedef T value_type;
+		template<typename U> struct rebind { typedef TrackingAllocator<U, TAG> other; };
+
+		TrackingAllocator() noexcept {}
+		template<typename U>
+		TrackingAllocator(const TrackingAllocator<U, TAG>&) noexcept {}
+
+		inline T *allocate(size_t count) {
+			T *ptr = (T *)::operator new(count * sizeof(T));
+			MemoryTracker::Allocated(TAG, count * sizeof(T));
+			return ptr;
+		}
+		inline void deallocate(T *ptr, size_t count) noexcept {
+			MemoryTracker::Freed(TAG, count * sizeof(T));
+			::operator delete(ptr);
+		}
+	};
+	template<typename T, typename U, MemoryTag TAG>
+	inline bool operator == (const TrackingAllocator<T, TAG>&, const TrackingAllocator<U, TAG>&) { return true; }
+	template<typename T, typename U, MemoryTag TAG>
+	inline bool operator != (const TrackingAllocator<T, TAG>&, const TrackingAllocator<U, TAG>&) { return false; }
+
+	template<typename T, MemoryTag TAG>
+	using TrackedVector = std::vector<T, TrackingAllocator<T, TAG>>;
+#else
+	/// <summary>
+	/// A plain std::vector unless TX_MEMORY_TRACKING is defined, when its storage is accounted to the tag.
+	/// </summary>
+	template<typename T, MemoryTag TAG>
+	using TrackedVector = std::vector<T>;
+#endif
+}
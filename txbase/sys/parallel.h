@@ -0,0 +1,105 @@
+#pragma once
+
+#include "txbase/sys/thread.h"
+
+namespace TX
+{
+	/// <summary>
+	/// Recursively bisects a range, queueing the right halves as tasks until a piece is no larger than the grain,
+	/// then combines the results of the pieces from left to right.
+	/// </summary>
+	template<typename T, typename Leaf, typename Reduce>
+	class ParallelSplitter {
+	private:
+		static const int MAX_DEPTH = 32;
+		struct Piece {
+			const ParallelSplitter *splitter;
+			int begin, end;
+			T result;
+		};
+	public:
+		ParallelSplitter(int grain, const Leaf& leaf, const Reduce& reduce) :
+			grain_(grain), leaf_(leaf), reduce_(reduce) {}
+
+		T Run(int begin, int end) const {
+			Piece pieces[MAX_DEPTH];
+			TaskGroup group;
+			int count = 0;
+			while (end - begin > grain_ && count < MAX_DEPTH) {
+				int mid = begin + (end - begin) / 2;
+				Piece& piece = pieces[count++];
+				piece.splitter = this;
+				piece.begin = mid;
+				piece.end = end;
+				group.Run(RunPiece, &piece);
+				end = mid;
+			}
+			T result = leaf_(begin, end);
+			group.Wait();
+			// the last forked piece is the closest to the leaf
+			for (int i = count - 1; i >= 0; i--)
+				result = reduce_(result, pieces[i].result);
+			return result;
+		}
+	private:
+		static void RunPiece(void *args, int /*id*/) {
+			Piece *piece = (Piece *)args;
+			piece->result = piece->splitter->Run(piece->begin, piece->end);
+		}
+	private:
+		const int grain_;
+		const Leaf& leaf_;
+		const Reduce& reduce_;
+	};
+
+	/// <summary>
+	/// Picks the grain size when the caller leaves it to the scheduler (grain <= 0),
+	/// aiming at a few pieces per worker so that stealing can balance the load.
+	/// </summary>
+	inline int ParallelGrain(int count, int grain) {
+		if (grain > 0)
+			return grain;
+		int threads = Math::Max(1, TaskScheduler::Instance()->ThreadCount());
+		return Math::Max(1, count / (threads * 8));
+	}
+
+	/// <summary>
+	/// Calls func(i) for every i in [begin, end) on the scheduler's workers and returns when all of them are done.
+	/// Runs on the calling thread if the scheduler isn't running.
+	/// </summary>
+	/// <param name="grain"> The largest range run as a single task, or 0 to pick one from the worker count </param>
+	template<typename Func>
+	void ParallelFor(int begin, int end, int grain, const Func& func) {
+		if (begin >= end)
+			return;
+		auto leaf = [&func](int b, int e) { for (int i = b; i < e; i++) func(i); return true; };
+		auto reduce = [](bool, bool) { return true; };
+		if (!TaskScheduler::Instance()->Running()) {
+			leaf(begin, end);
+			return;
+		}
+		grain = ParallelGrain(end - begin, grain);
+		ParallelSplitter<bool, decltype(leaf), decltype(reduce)>(grain, leaf, reduce).Run(begin, end);
+	}
+
+	/// <summary>
+	/// Computes reduce(...reduce(reduce(identity, map(begin)), map(begin + 1))..., map(end - 1)) in parallel.
+	/// The reduce function must be associative, the pieces are always combined in order.
+	/// </summary>
+	/// <param name="grain"> The largest range run as a single task, or 0 to pick one from the worker count </param>
+	template<typename T, typename Map, typename Reduce>
+	T ParallelReduce(int begin, int end, int grain, const T& identity, const Map& map, const Reduce& reduce) {
+		if (begin >= end)
+			return identity;
+		auto leaf = [&](int b, int e) {
+			T result = identity;
+			for (int i = b; i < e; i++)
+				result = reduce(result, map(i));
+			return result;
+		};
+		if (!TaskScheduler::Instance()->Running())
+			return leaf(begin, end);
+		grain = ParallelGrain(end - begin, grain);
+		return ParallelSplitter<T, decltype(leaf), Reduce>(grain, leaf, reduce).Run(begin, end);
+	}
+}
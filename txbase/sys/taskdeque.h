@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
+#include <cstdint>
+#include "txbase/sys/memory.h"
+
+namespace TX
+{
+	/// <summary>
+	/// Lock-free work-stealing deque (Chase-Lev) holding pointers to items.
+	/// The owner thread pushes and pops at the bottom, any other thread steals from the top.
+	/// Memory orders follow "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+	/// </summary>
+	template<typename T>
+	class TaskDeque : NonCopyable {
+	private:
+		class Buffer {
+		public:
+			Buffer(int64_t capacity) :
+				capacity(capacity),
+				mask(capacity - 1),
+				slots(new std::atomic<T *>[capacity]) {}
+			inline T *Get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+			inline void Put(int64_t i, T *item) { slots[i & mask].store(item, std::memory_order_relaxed); }
+			/// <summary>
+			/// Copies the live range [top, bottom) into a buffer twice as large.
+			/// </summary>
+			inline Buffer *Grow(int64_t bottom, int64_t top) const {
+				Buffer *buffer = new Buffer(capacity << 1);
+				for (int64_t i = top; i < bottom; i++)
+					buffer->Put(i, Get(i));
+				return buffer;
+			}
+		public:
+			const int64_t capacity, mask;
+		private:
+			std::unique_ptr<std::atomic<T *>[]> slots;
+		};
+
+	public:
+		/// <summary>
+		/// Capacity must be a power of 2, the deque grows by doubling when it is full.
+		/// </summary>
+		TaskDeque(int64_t capacity = 256) : top_(0), bottom_(0) {
+			assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+			Buffer *buffer = new Buffer(capacity);
+			buffers_.emplace_back(buffer);
+			buffer_.store(buffer, std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// top_ and bottom_ are over-aligned, which a plain new only honors from C++17 on.
+		/// </summary>
+		static void *operator new(size_t size) {
+			void *ptr = AllocAligned<char>(uint32_t(size), alignof(TaskDeque), MemoryTag::Scheduler);
+			if (!ptr) throw std::bad_alloc();
+			return ptr;
+		}
+		static void operator delete(void *ptr) { FreeAligned(ptr); }
+
+		/// <summary>
+		/// Owner only. Pushes an item to the bottom.
+		/// </summary>
+		void Push(T *item) {
+			int64_t b = bottom_.load(std::memory_order_relaxed);
+			int64_t t = top_.load(std::memory_order_acquire);
+			Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+			if (b - t > buffer->capacity - 1) {
+				// old buffers are kept alive since a thief may still be reading them
+				buffer = buffer->Grow(b, t);
+				buffers_.emplace_back(buffer);
+				buffer_.store(buffer, std::memory_order_release);
+			}
+			buffer->Put(b, item);
+			// a release store rather than a release fence, same code on x86 and visible to race detectors
+			bottom_.store(b + 1, std::memory_order_release);
+		}
+
+		/// <summary>
+		/// Owner only. Pops the most recently pushed item, or nullptr if the deque is empty.
+		/// </summary>
+		T *Pop() {
+			int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+			Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+			bottom_.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top_.load(std::memory_order_relaxed);
+			T *item = nullptr;
+			if (t <= b) {
+				item = buffer->Get(b);
+				if (t == b) {
+					// last item, race against the thieves
+					if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						item = nullptr;
+					bottom_.store(b + 1, std::memory_order_relaxed);
+				}
+			}
+			else {
+				bottom_.store(b + 1, std::memory_order_relaxed);
+			}
+			return item;
+		}
+
+		/// <summary>
+		/// Any thread. Takes the oldest item, or nullptr if the deque is empty or another thread won the race.
+		/// </summary>
+		T *Steal() {
+			int64_t t = top_.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom_.load(std::memory_order_acquire);
+			if (t < b) {
+				Buffer *buffer = buffer_.load(std::memory_order_acquire);
+				T *item = buffer->Get(t);
+				if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+				return item;
+			}
+			return nullptr;
+		}
+
+		/// <summary>
+		/// Approximated number of items, exact only when called by the owner with no thieves around.
+		/// </summary>
+		inline int64_t Size() const {
+			int64_t b = bottom_.load(std::memory_order_relaxed);
+			int64_t t = top_.load(std::memory_order_relaxed);
+			return b > t ? b - t : 0;
+		}
+		inline bool Empty() const { return Size() == 0; }
+
+	private:
+		alignas(64) std::atomic<int64_t> top_;
+		alignas(64) std::atomic<int64_t> bottom_;
+		std::atomic<Buffer *> buffer_;
+		std::vector<std::unique_ptr<Buffer>> buffers_;	// every buffer ever used, released with the deque
+	};
+}
@@ -0,0 +1,77 @@
+#include "txbase/stdafx.h"
+#include "taskgraph.h"
+
+namespace TX
+{
+	TaskGraph::Node TaskGraph::AddNode(TaskScheduler::Task task){
+		assert(group_.Count() == 0);
+		nodes_.emplace_back(this, std::move(task));
+		validated_ = false;
+		return Node(nodes_.size() - 1);
+	}
+
+	void TaskGraph::Precede(Node before, Node after){
+		assert(group_.Count() == 0);
+		assert(before >= 0 && before < NodeCount() && after >= 0 && after < NodeCount());
+		nodes_[before].successors.push_back(&nodes_[after]);
+		nodes_[after].predecessors++;
+		validated_ = false;
+	}
+
+	void TaskGraph::Clear(){
+		assert(group_.Count() == 0);
+		nodes_.clear();
+		roots_.clear();
+		validated_ = true;
+	}
+
+	void TaskGraph::Run(){
+		assert(group_.Count() == 0);		// the previous run must be finished
+		if (!validated_)
+			Validate();
+		for (auto& node : nodes_)
+			node.remaining.store(node.predecessors, std::memory_order_relaxed);
+		for (GraphNode *root : roots_)
+			group_.Run(RunNode, root);
+	}
+
+	void TaskGraph::Validate(){
+		// Kahn's algorithm, every node has to be reached from the roots
+		roots_.clear();
+		std::vector<GraphNode *> ready;
+		for (auto& node : nodes_){
+			node.remaining = node.predecessors;
+			if (node.predecessors == 0){
+				roots_.push_back(&node);
+				ready.push_back(&node);
+			}
+		}
+		size_t visited = 0;
+		while (!ready.empty()){
+			GraphNode *node = ready.back();
+			ready.pop_back();
+			visited++;
+			for (GraphNode *successor : node->successors){
+				if (--successor->remaining == 0)
+					ready.push_back(successor);
+			}
+		}
+		if (visited != nodes_.size())
+			throw std::runtime_error("TaskGraph has a cycle");
+		validated_ = true;
+	}
+
+	void TaskGraph::Release(GraphNode *node){
+		for (GraphNode *successor : node->successors){
+			if (successor->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				group_.Run(RunNode, successor);
+		}
+	}
+
+	void TaskGraph::RunNode(void *args, int id){
+		GraphNode *node = (GraphNode *)args;
+		node->task.Run(id);
+		// successors join the group before this node leaves it, so Wait() can't return in between
+		node->graph->Release(node);
+	}
+}
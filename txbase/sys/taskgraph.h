@@ -0,0 +1,63 @@
+#pragma once
+
+#include "txbase/sys/thread.h"
+#include <deque>
+
+namespace TX
+{
+	/// <summary>
+	/// Tasks with dependencies, run on a TaskScheduler.
+	/// A node is queued as soon as all of its predecessors are finished, so independent branches overlap.
+	/// A built graph can be run again (e.g. every frame) without allocating.
+	/// </summary>
+	class TaskGraph : NonCopyable {
+	public:
+		typedef int Node;
+	private:
+		struct GraphNode {
+			GraphNode(TaskGraph *graph, TaskScheduler::Task&& task) :
+				graph(graph), task(std::move(task)), predecessors(0), remaining(0) {}
+			TaskGraph *graph;
+			TaskScheduler::Task task;
+			std::vector<GraphNode *> successors;
+			int predecessors;
+			std::atomic_int remaining;		// predecessors not finished in the current run
+		};
+	public:
+		TaskGraph(TaskScheduler *scheduler = TaskScheduler::Instance()) : group_(scheduler), validated_(true) {}
+		~TaskGraph() { Wait(); }
+
+		Node AddNode(TaskScheduler::Task task);
+		inline Node AddNode(TaskScheduler::Task::Func func, void *args) { return AddNode(TaskScheduler::Task(func, args)); }
+		/// <summary>
+		/// Makes <paramref name="after"/> wait for <paramref name="before"/>.
+		/// </summary>
+		void Precede(Node before, Node after);
+		inline int NodeCount() const { return int(nodes_.size()); }
+		/// <summary>
+		/// Removes all nodes, the graph must not be running.
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Queues the nodes without predecessors and returns, the others follow as their dependencies finish.
+		/// Throws if the graph has a cycle.
+		/// </summary>
+		void Run();
+		/// <summary>
+		/// Waits for the current run, helping like TaskGroup::Wait().
+		/// </summary>
+		inline void Wait() { group_.Wait(); }
+		inline void Execute() { Run(); Wait(); }
+
+	private:
+		void Validate();
+		void Release(GraphNode *node);
+		static void RunNode(void *args, int id);
+	private:
+		std::deque<GraphNode> nodes_;		// stable addresses
+		std::vector<GraphNode *> roots_;
+		TaskGroup group_;
+		bool validated_;
+	};
+}
@@ -0,0 +1,85 @@
+#include "txbase/stdafx.h"
+#include "telemetry.h"
+
+namespace TX
+{
+	int64_t WorkerTelemetry::Now(){
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	WorkerStats WorkerTelemetry::Stats() const {
+		WorkerStats stats;
+		stats.tasks_run = tasks_run_.load(std::memory_order_relaxed);
+		stats.busy_ns = busy_ns_.load(std::memory_order_relaxed);
+		stats.idle_ns = idle_ns_.load(std::memory_order_relaxed);
+		stats.wakeups = wakeups_.load(std::memory_order_relaxed);
+		stats.steals = steals_.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void WorkerTelemetry::Reset(){
+		tasks_run_ = 0;
+		busy_ns_ = 0;
+		idle_ns_ = 0;
+		wakeups_ = 0;
+		steals_ = 0;
+	}
+
+	void WorkerTelemetry::EndTask(int64_t begin_ns, int64_t end_ns, bool background, bool trace){
+		if (--depth_ == 0)
+			Add(busy_ns_, uint64_t(end_ns - begin_ns));
+		Add(tasks_run_, 1);
+		if (trace)
+			Record(begin_ns, end_ns, background ? EVENT_BACKGROUND_TASK : EVENT_TASK);
+	}
+
+	void WorkerTelemetry::Idle(int64_t begin_ns, int64_t end_ns, bool trace){
+		Add(idle_ns_, uint64_t(end_ns - begin_ns));
+		if (trace)
+			Record(begin_ns, end_ns, EVENT_IDLE);
+	}
+
+	void WorkerTelemetry::Record(int64_t begin_ns, int64_t end_ns, EventType type){
+		std::unique_lock<std::mutex> lock(events_mutex_);
+		events_.push_back({ begin_ns, end_ns, type });
+	}
+
+	void WorkerTelemetry::TakeEvents(std::vector<Event>& events){
+		std::unique_lock<std::mutex> lock(events_mutex_);
+		events.insert(events.end(), events_.begin(), events_.end());
+		events_.clear();
+	}
+
+	void WriteChromeTrace(std::ostream& out, int64_t origin_ns,
+		const std::vector<WorkerTelemetry *>& threads, const std::vector<QueueDepthSample>& samples)
+	{
+		static const char *names[] = { "task", "background task", "idle" };
+		auto us = [origin_ns](int64_t ns) { return double(ns - origin_ns) * 1e-3; };
+		std::ios::fmtflags flags = out.flags();
+		out << std::fixed << std::setprecision(3);
+		out << "{\"traceEvents\":[\n";
+		bool first = true;
+		auto separate = [&]() { if (!first) out << ",\n"; first = false; };
+		std::vector<WorkerTelemetry::Event> events;
+		for (size_t tid = 0; tid < threads.size(); tid++){
+			separate();
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+				<< ",\"args\":{\"name\":\"" << threads[tid]->Name() << "\"}}";
+			events.clear();
+			threads[tid]->TakeEvents(events);
+			for (auto& event : events){
+				separate();
+				out << "{\"name\":\"" << names[event.type] << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+					<< ",\"ts\":" << us(event.begin_ns) << ",\"dur\":" << double(event.end_ns - event.begin_ns) * 1e-3 << "}";
+			}
+		}
+		for (auto& sample : samples){
+			separate();
+			out << "{\"name\":\"queue depth\",\"ph\":\"C\",\"pid\":0,\"ts\":" << us(sample.time_ns)
+				<< ",\"args\":{\"interactive\":" << sample.interactive << ",\"background\":" << sample.background << "}}";
+		}
+		out << "\n]}\n";
+		out.flags(flags);
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "txbase/fwddecl.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <ostream>
+#include <string>
+
+namespace TX
+{
+	/// <summary>
+	/// Counters of a scheduler thread. Times are only measured while telemetry or tracing is enabled.
+	/// </summary>
+	struct WorkerStats {
+		WorkerStats() : tasks_run(0), busy_ns(0), idle_ns(0), wakeups(0), steals(0) {}
+		uint64_t tasks_run;
+		uint64_t busy_ns;		// running tasks, nested tasks count once
+		uint64_t idle_ns;		// spinning, yielding or parked
+		uint64_t wakeups;		// times woken up after parking
+		uint64_t steals;		// tasks taken from other workers
+		inline WorkerStats& operator += (const WorkerStats& other) {
+			tasks_run += other.tasks_run; busy_ns += other.busy_ns; idle_ns += other.idle_ns;
+			wakeups += other.wakeups; steals += other.steals;
+			return *this;
+		}
+		inline double Utilization() const { return busy_ns + idle_ns ? double(busy_ns) / double(busy_ns + idle_ns) : 0.0; }
+	};
+
+	/// <summary>
+	/// Tasks queued but not started, sampled while tracing.
+	/// </summary>
+	struct QueueDepthSample {
+		int64_t time_ns;
+		int interactive;
+		int background;
+	};
+
+	/// <summary>
+	/// Counters and trace events of one scheduler thread. Only the owning thread writes them,
+	/// others may read the counters at any time and the events once tracing stopped.
+	/// </summary>
+	class WorkerTelemetry : NonCopyable {
+	public:
+		enum EventType {
+			EVENT_TASK,
+			EVENT_BACKGROUND_TASK,
+			EVENT_IDLE,
+		};
+		struct Event {
+			int64_t begin_ns, end_ns;
+			EventType type;
+		};
+	public:
+		WorkerTelemetry(const std::string& name) : name_(name), depth_(0) { Reset(); }
+
+		/// <summary>
+		/// Nanoseconds of a monotonic clock.
+		/// </summary>
+		static int64_t Now();
+
+		inline const std::string& Name() const { return name_; }
+		WorkerStats Stats() const;
+		void Reset();
+
+		inline void CountSteal() { Add(steals_, 1); }
+		inline void CountWakeup() { Add(wakeups_, 1); }
+		/// <summary>
+		/// Called around every task, the time of nested tasks is only counted by the outermost one.
+		/// </summary>
+		inline void BeginTask() { depth_++; }
+		void EndTask(int64_t begin_ns, int64_t end_ns, bool background, bool trace);
+		inline void EndTaskUntimed() { depth_--; Add(tasks_run_, 1); }
+		void Idle(int64_t begin_ns, int64_t end_ns, bool trace);
+
+		/// <summary>
+		/// Moves the recorded events to the end of events.
+		/// </summary>
+		void TakeEvents(std::vector<Event>& events);
+	private:
+		// single writer, so no read-modify-write is needed
+		static inline void Add(std::atomic<uint64_t>& counter, uint64_t value) {
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+		void Record(int64_t begin_ns, int64_t end_ns, EventType type);
+	private:
+		std::string name_;
+		int depth_;
+		std::atomic<uint64_t> tasks_run_, busy_ns_, idle_ns_, wakeups_, steals_;
+		std::mutex events_mutex_;	// only contended while the trace is written
+		std::vector<Event> events_;
+	};
+
+	/// <summary>
+	/// Writes the events of every thread and the queue depth samples in the Chrome trace event format
+	/// (chrome://tracing, Perfetto), with times relative to origin_ns.
+	/// </summary>
+	void WriteChromeTrace(std::ostream& out, int64_t origin_ns,
+		const std::vector<WorkerTelemetry *>& threads, const std::vector<QueueDepthSample>& samples);
+}
@@ -1,33 +1,75 @@
 #include "txbase/stdafx.h"
 #include "thread.h"
 #include "memory.h"
+#include "tools.h"
+
+#include <xmmintrin.h>
 
 namespace TX
 {
-	// Get a task from the scheduler and run it
-	void TaskScheduler::Worker::WorkLoop(){
-		Task task;
-		while(scheduler_->Running()){
-			{// critical region
-				std::unique_lock<std::mutex> tasks_lock(scheduler_->tasks_mutex_);
+	namespace {
+		ObjectPool<TaskScheduler::Task, true> task_pool;
 
-				while (scheduler_->Running() && scheduler_->tasks.empty()){
-					scheduler_->task_available_cv_.wait(tasks_lock);
-				}
-				if (!scheduler_->Running()) return;
+		inline void FreeTask(TaskScheduler::Task *task){
+			task_pool.Delete(task);
+		}
+	}
 
-				// take the oldest task
-				task = scheduler_->tasks.front();
-				scheduler_->tasks.pop_front();
-			}
+	void *TaskScheduler::Task::AllocStorage(size_t size){
+		if (size <= 128) return SharedBlockPool<128>::Alloc();
+		if (size <= 256) return SharedBlockPool<256>::Alloc();
+		if (size <= 512) return SharedBlockPool<512>::Alloc();
+		void *ptr = AllocAligned<char>(uint32_t(size), 64, MemoryTag::Scheduler);
+		if (!ptr) throw std::bad_alloc();
+		return ptr;
+	}
+	void TaskScheduler::Task::FreeStorage(void *ptr, size_t size){
+		if (size <= 128) SharedBlockPool<128>::Free(ptr);
+		else if (size <= 256) SharedBlockPool<256>::Free(ptr);
+		else if (size <= 512) SharedBlockPool<512>::Free(ptr);
+		else FreeAligned(ptr);
+	}
 
-			task.Run(id_);
+	thread_local TaskScheduler::Worker *TaskScheduler::current_worker_ = nullptr;
+	thread_local TaskScheduler *TaskScheduler::current_helper_ = nullptr;
 
-			if (--scheduler_->task_count_ == 0){
-				// only ThreadScheduler->JoinAll waits for this condition
-				scheduler_->task_finished_cv_.notify_one();
+	int TaskScheduler::Worker::Node() const {
+		const CpuTopology& topology = CpuTopology::Get();
+		int node = -1;
+		for (int cpu : affinity_){
+			const CpuTopology::Processor *processor = topology.Find(cpu);
+			if (!processor || (node >= 0 && processor->node != node))
+				return -1;
+			node = processor->node;
+		}
+		return node;
+	}
+
+	// Get a task from the scheduler and run it
+	void TaskScheduler::Worker::WorkLoop(){
+		current_worker_ = this;
+		if (!affinity_.empty())
+			pinned_ = CpuTopology::PinThread(affinity_);
+		// first touched by this thread, so the OS places them on the worker's node
+		for (auto& tasks : tasks_)
+			tasks.reset(new TaskDeque<Task>);
+		scheduler_->WorkerStarted();
+		while (scheduler_->Running()){
+			Priority priority;
+			Task *task = scheduler_->TakeTask(this, priority);
+			if (task){
+				scheduler_->RunTask(task, id_, priority);
+				continue;
 			}
+			WorkerTelemetry& telemetry = scheduler_->ThreadTelemetry(this);
+			bool timed = scheduler_->Timed();
+			int64_t begin = timed ? WorkerTelemetry::Now() : 0;
+			if (scheduler_->Idle())
+				telemetry.CountWakeup();
+			if (timed)
+				telemetry.Idle(begin, WorkerTelemetry::Now(), scheduler_->Tracing());
 		}
+		current_worker_ = nullptr;
 	}
 
 	TaskScheduler* TaskScheduler::instance = nullptr;
@@ -40,43 +82,452 @@ namespace TX
 	void TaskScheduler::DeleteInstance(){
 		if (instance){
 			instance->StopAll();
+			for (auto& tasks : instance->injected_tasks_){
+				for (Task *task : tasks)
+					FreeTask(task);
+			}
 			MemDelete(instance);
 		}
 	}
 	void TaskScheduler::StartAll(){
-		int processor_count = std::thread::hardware_concurrency();
+		StartAll(config_);
+	}
+
+	void TaskScheduler::StartAll(const Config& config){
+		assert(workers_.empty());
+		config_ = config;
+		const CpuTopology& topology = CpuTopology::Get();
+		// usable processors in the order they are handed out: cores before SMT siblings,
+		// alternating between the nodes if the workers are spread over them
+		std::vector<int> order = topology.PlacementOrder(config.numa_aware);
+		if (!config.cpus.empty()){
+			order.erase(std::remove_if(order.begin(), order.end(), [&config](int cpu){
+				return std::find(config.cpus.begin(), config.cpus.end(), cpu) == config.cpus.end();
+			}), order.end());
+			assert(!order.empty() && "none of the configured processors can be used");
+			if (order.empty())
+				order = topology.PlacementOrder(config.numa_aware);
+		}
+		int worker_count = config.worker_count;
+		if (worker_count <= 0){
+			worker_count = int(order.size());
 #ifdef _DEBUG
-		processor_count = 1;
+			worker_count = 1;
 #endif
+		}
+
+		spin_count_ = worker_count <= int(order.size()) ? config.spin_count : 0;
+		background_limit_ = config.background_workers > 0 ?
+			Math::Min(config.background_workers, worker_count) :
+			Math::Max(1, worker_count - 1);
+
+		telemetry_.clear();
+		for (int i = 0; i < worker_count; i++)
+			telemetry_.emplace_back(new WorkerTelemetry(Str("worker ", i)));
+		telemetry_.emplace_back(new WorkerTelemetry("helper"));
+
 		running_ = true;
-		for (int i = 0; i < processor_count; i++){
-			threads.emplace_back(this, i);
+		started_count_ = 0;
+		workers_.reserve(worker_count);
+		for (int i = 0; i < worker_count; i++){
+			int cpu = order[i % order.size()];
+			std::vector<int> affinity;
+			if (config.pin_workers){
+				affinity.push_back(cpu);
+			}
+			else if (config.numa_aware){
+				// any processor of the node, as long as it is usable
+				for (int member : topology.NodeProcessors(topology.Find(cpu)->node)){
+					if (std::find(order.begin(), order.end(), member) != order.end())
+						affinity.push_back(member);
+				}
+			}
+			else if (!config.cpus.empty()){
+				affinity = order;
+			}
+			workers_.emplace_back(new Worker(this, i, affinity));
+		}
+		// thieves only look at workers whose deque exists
+		std::unique_lock<std::mutex> lock(start_mutex_);
+		while (started_count_ < worker_count){
+			started_cv_.wait(lock);
 		}
+		worker_count_ = worker_count;
+	}
+
+	void TaskScheduler::WorkerStarted(){
+		std::unique_lock<std::mutex> lock(start_mutex_);
+		started_count_++;
+		started_cv_.notify_all();
 	}
 
 	void TaskScheduler::StopAll(){
 		running_ = false;
 		{
 			// wake up all workers so they can stop by themselves
-			std::unique_lock<std::mutex> lock(tasks_mutex_);
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
 			task_available_cv_.notify_all();
 		}
-		for (uint32_t i = 0; i < threads.size(); i++){
-			threads[i].join();
+		for (auto& worker : workers_){
+			worker->Join();
 		}
-		threads.clear();
-	}
-	void TaskScheduler::AddTask(Task& newTask) {
+		// keep the unfinished tasks for the next StartAll()
 		std::unique_lock<std::mutex> lock(tasks_mutex_);
-		tasks.push_back(newTask);
+		for (auto& worker : workers_){
+			for (int lane = 0; lane < PRIORITY_COUNT; lane++){
+				while (Task *task = worker->tasks_[lane]->Pop()){
+					injected_tasks_[lane].push_back(task);
+					injected_count_[lane]++;
+				}
+			}
+		}
+		worker_count_ = 0;
+		workers_.clear();
+	}
+	void TaskScheduler::AddTask(Task& newTask, Priority priority) {
+		Submit(task_pool.New(newTask), nullptr, Resolve(priority));
+	}
+	void TaskScheduler::AddTask(Task&& newTask, Priority priority) {
+		Submit(task_pool.New(std::move(newTask)), nullptr, Resolve(priority));
+	}
+	void TaskScheduler::AddTask(Task& newTask, TaskGroup *group) {
+		Submit(task_pool.New(newTask), group, Resolve(group ? group->priority_ : Priority::Inherit));
+	}
+	void TaskScheduler::AddTask(Task&& newTask, TaskGroup *group) {
+		Submit(task_pool.New(std::move(newTask)), group, Resolve(group ? group->priority_ : Priority::Inherit));
+	}
+	void TaskScheduler::Submit(Task *task, TaskGroup *group, Priority priority) {
+		int lane = int(priority);
+		task->group = group;
+		if (group)
+			group->Add();
 		task_count_++;
-		task_available_cv_.notify_one();
+		pending_count_[lane]++;
+		Worker *worker = current_worker_;
+		if (worker && worker->scheduler_ == this){
+			worker->tasks_[lane]->Push(task);
+		}
+		else {
+			std::unique_lock<std::mutex> lock(tasks_mutex_);
+			injected_tasks_[lane].push_back(task);
+			injected_count_[lane]++;
+		}
+		WakeOne();
 	}
+	void TaskScheduler::AddTasks(const Task *tasks, size_t count, TaskGroup *group) {
+		if (count == 0)
+			return;
+		int lane = int(Resolve(group ? group->priority_ : Priority::Inherit));
+		if (group)
+			group->Add(int(count));
+		task_count_ += int(count);
+		pending_count_[lane] += int(count);
+		Worker *worker = current_worker_;
+		if (worker && worker->scheduler_ == this){
+			for (size_t i = 0; i < count; i++){
+				Task *task = task_pool.New(tasks[i]);
+				task->group = group;
+				worker->tasks_[lane]->Push(task);
+			}
+			// the worker takes one of them itself
+			Wake(int(count) - 1);
+		}
+		else {
+			std::unique_lock<std::mutex> lock(tasks_mutex_);
+			for (size_t i = 0; i < count; i++){
+				Task *task = task_pool.New(tasks[i]);
+				task->group = group;
+				injected_tasks_[lane].push_back(task);
+			}
+			injected_count_[lane] += int(count);
+			lock.unlock();
+			Wake(int(count));
+		}
+	}
+
 	void TaskScheduler::JoinAll(){
+		while (task_count_ > 0 && TryRunTask());
 		std::unique_lock<std::mutex> lock(finished_mutex_);
 
 		while (task_count_ > 0){
 			task_finished_cv_.wait(lock);
 		}
 	}
+
+	bool TaskScheduler::TryRunTask(){
+		if (IsWorkerThread()){
+			Worker *worker = current_worker_;
+			Priority priority;
+			Task *task = TakeTask(worker, priority);
+			if (!task)
+				return false;
+			RunTask(task, worker->id_, priority);
+			return true;
+		}
+		// a thread outside of the pool borrows the extra slot, which it keeps while running nested waits
+		bool claimed = false;
+		if (current_helper_ != this){
+			if (!running_ || helper_slot_.test_and_set(std::memory_order_acquire))
+				return false;
+			current_helper_ = this;
+			claimed = true;
+		}
+		// only interactive tasks, a long background task would stall the waiting thread (usually the UI)
+		Task *task = TakeFrom(nullptr, Priority::Interactive);
+		if (task)
+			RunTask(task, ThreadCount(), Priority::Interactive);
+		if (claimed){
+			current_helper_ = nullptr;
+			helper_slot_.clear(std::memory_order_release);
+		}
+		return task != nullptr;
+	}
+
+	TaskScheduler::Task *TaskScheduler::TakeTask(Worker *worker, Priority& priority){
+		const int background = int(Priority::Background);
+		bool background_first = worker->streak_ >= config_.starvation_limit;
+		for (int i = 0; i < PRIORITY_COUNT; i++){
+			priority = Priority(background_first ? PRIORITY_COUNT - 1 - i : i);
+			if (Task *task = TakeFrom(worker, priority)){
+				if (priority == Priority::Interactive && pending_count_[background] > 0)
+					worker->streak_++;
+				else
+					worker->streak_ = 0;
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	TaskScheduler::Task *TaskScheduler::TakeFrom(Worker *worker, Priority priority){
+		int lane = int(priority);
+		// tasks are counted before they are queued
+		if (pending_count_[lane].load(std::memory_order_relaxed) == 0)
+			return nullptr;
+		// a worker waiting inside a background task reuses its slot
+		bool slot = priority == Priority::Background && !(worker && worker->priority_ == Priority::Background);
+		if (slot && !AcquireBackgroundSlot())
+			return nullptr;
+		Task *task = worker ? worker->tasks_[lane]->Pop() : nullptr;
+		if (!task)
+			task = TakeInjected(lane);
+		if (!task){
+			task = Steal(worker, lane, worker ? worker->NextRandom() : helper_seed_++);
+			if (task)
+				ThreadTelemetry(worker).CountSteal();
+		}
+		if (task)
+			pending_count_[lane]--;
+		else if (slot)
+			ReleaseBackgroundSlot();
+		return task;
+	}
+
+	TaskScheduler::Task *TaskScheduler::TakeInjected(int lane){
+		if (injected_count_[lane].load(std::memory_order_relaxed) == 0)
+			return nullptr;
+		std::unique_lock<std::mutex> lock(tasks_mutex_);
+		if (injected_tasks_[lane].empty())
+			return nullptr;
+		// take the oldest task
+		Task *task = injected_tasks_[lane].front();
+		injected_tasks_[lane].pop_front();
+		injected_count_[lane]--;
+		return task;
+	}
+
+	TaskScheduler::Task *TaskScheduler::Steal(Worker *thief, int lane, uint32_t random){
+		int count = worker_count_;
+		if (count < (thief ? 2 : 1))
+			return nullptr;
+		int start = int(random % uint32_t(count));
+		for (int i = 0; i < count; i++){
+			Worker *victim = workers_[(start + i) % count].get();
+			if (victim == thief)
+				continue;
+			if (Task *task = victim->tasks_[lane]->Steal())
+				return task;
+		}
+		return nullptr;
+	}
+
+	void TaskScheduler::RunTask(Task *task, int id, Priority priority){
+		Worker *worker = IsWorkerThread() ? current_worker_ : nullptr;
+		Priority outer = worker ? worker->priority_ : Priority::Interactive;
+		if (worker)
+			worker->priority_ = priority;
+		WorkerTelemetry& telemetry = ThreadTelemetry(worker);
+		bool trace = tracing_;
+		bool timed = trace || config_.telemetry;
+		int64_t begin = timed ? WorkerTelemetry::Now() : 0;
+		if (trace)
+			SampleQueueDepth(begin);
+		telemetry.BeginTask();
+		task->Run(id);
+		if (timed)
+			telemetry.EndTask(begin, WorkerTelemetry::Now(), priority == Priority::Background, trace);
+		else
+			telemetry.EndTaskUntimed();
+		if (worker)
+			worker->priority_ = outer;
+		// release the callable before the group can see the task finished
+		TaskGroup *group = task->group;
+		FreeTask(task);
+		if (priority == Priority::Background && outer != Priority::Background)
+			ReleaseBackgroundSlot();
+		if (group)
+			group->Finish();
+		if (--task_count_ == 0){
+			// only JoinAll() waits for this condition
+			std::unique_lock<std::mutex> lock(finished_mutex_);
+			task_finished_cv_.notify_all();
+		}
+	}
+
+	bool TaskScheduler::AcquireBackgroundSlot(){
+		int running = background_running_;
+		while (running < background_limit_){
+			if (background_running_.compare_exchange_weak(running, running + 1))
+				return true;
+		}
+		return false;
+	}
+
+	void TaskScheduler::ReleaseBackgroundSlot(){
+		background_running_--;
+		// pairs with Park(): a worker held back by the limit may take a background task now
+		if (pending_count_[int(Priority::Background)] > 0)
+			WakeOne();
+	}
+
+	bool TaskScheduler::Idle(){
+		for (int round = 0; round < spin_count_; round++){
+			if (HasWork() || !running_)
+				return false;
+			for (int i = 1 << Math::Min(round, 5); i > 0; i--)
+				_mm_pause();
+		}
+		for (int round = 0; round < config_.yield_count; round++){
+			if (HasWork() || !running_)
+				return false;
+			std::this_thread::yield();
+		}
+		return Park();
+	}
+
+	bool TaskScheduler::Park(){
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		sleeping_count_++;
+		bool waited = false;
+		// pairs with AddTask(): either the new task is seen here, or the sleeper is seen there
+		while (running_ && !HasWork()){
+			task_available_cv_.wait(lock);
+			waited = true;
+		}
+		sleeping_count_--;
+		return waited;
+	}
+
+	void TaskScheduler::WakeOne(){
+		if (sleeping_count_ > 0){
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
+			task_available_cv_.notify_one();
+		}
+	}
+
+	void TaskScheduler::Wake(int count){
+		int sleeping = sleeping_count_;
+		if (count <= 0 || sleeping == 0)
+			return;
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		if (count >= sleeping)
+			task_available_cv_.notify_all();
+		else {
+			while (count-- > 0)
+				task_available_cv_.notify_one();
+		}
+	}
+
+	WorkerStats TaskScheduler::GetTotalStats() const {
+		WorkerStats total;
+		for (auto& telemetry : telemetry_)
+			total += telemetry->Stats();
+		return total;
+	}
+
+	void TaskScheduler::ResetStats(){
+		for (auto& telemetry : telemetry_)
+			telemetry->Reset();
+	}
+
+	void TaskScheduler::StartTrace(){
+		{
+			std::unique_lock<std::mutex> lock(samples_mutex_);
+			samples_.clear();
+		}
+		std::vector<WorkerTelemetry::Event> discarded;
+		for (auto& telemetry : telemetry_)
+			telemetry->TakeEvents(discarded);
+		trace_origin_ns_ = WorkerTelemetry::Now();
+		last_sample_ns_ = 0;
+		tracing_ = true;
+	}
+
+	void TaskScheduler::StopTrace(){
+		tracing_ = false;
+	}
+
+	void TaskScheduler::WriteTrace(std::ostream& out){
+		std::vector<WorkerTelemetry *> threads;
+		for (auto& telemetry : telemetry_)
+			threads.push_back(telemetry.get());
+		std::vector<QueueDepthSample> samples;
+		{
+			std::unique_lock<std::mutex> lock(samples_mutex_);
+			samples.swap(samples_);
+		}
+		WriteChromeTrace(out, trace_origin_ns_, threads, samples);
+	}
+
+	void TaskScheduler::SampleQueueDepth(int64_t now_ns){
+		int64_t last = last_sample_ns_;
+		if (now_ns - last < SAMPLE_INTERVAL_NS || !last_sample_ns_.compare_exchange_strong(last, now_ns))
+			return;
+		QueueDepthSample sample = {
+			now_ns,
+			pending_count_[int(Priority::Interactive)],
+			pending_count_[int(Priority::Background)]
+		};
+		std::unique_lock<std::mutex> lock(samples_mutex_);
+		samples_.push_back(sample);
+	}
+
+	void TaskGroup::Finish(){
+		// only the last task takes the lock, so that the waiter can't return (and destroy the group) before
+		// the notification is done
+		int count = count_;
+		while (count > 1){
+			if (count_.compare_exchange_weak(count, count - 1))
+				return;
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (--count_ == 0)
+			finished_cv_.notify_all();
+	}
+
+	void TaskGroup::Wait(){
+		bool worker = scheduler_->IsWorkerThread();
+		while (count_ > 0){
+			if (scheduler_->TryRunTask())
+				continue;
+			// a worker keeps looking for work, the tasks of the group may still spawn more
+			if (!worker)
+				break;
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (count_ > 0){
+			finished_cv_.wait(lock);
+		}
+	}
 }
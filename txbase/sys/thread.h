@@ -1,6 +1,9 @@
 #pragma once
 
 #include "txbase/fwddecl.h"
+#include "txbase/sys/taskdeque.h"
+#include "txbase/sys/cpu.h"
+#include "txbase/sys/telemetry.h"
 
 #include <vector>
 #include <thread>
@@ -8,75 +11,449 @@
 #include <condition_variable>
 #include <deque>
 #include <atomic>
+#include <memory>
+#include <type_traits>
 
 namespace TX{
+	class TaskGroup;
+
 	/// <summary>
 	/// TaskScheduler that assigns tasks to worker threads.
+	/// Every worker owns a work-stealing deque, idle workers steal from a random victim.
 	/// </summary>
 	class TaskScheduler {
 	public:
+		class Task;
+
+		/// <summary>
+		/// Lanes of queued tasks. Interactive tasks are taken first; background tasks run on a limited number of
+		/// workers, and now and then go ahead of the interactive ones so that they can't starve.
+		/// </summary>
+		enum class Priority {
+			Inherit = -1,	// the priority of the running task, Interactive outside of the workers
+			Interactive,
+			Background,
+		};
+		static const int PRIORITY_COUNT = 2;
+
+		/// <summary>
+		/// How many workers to start and where to place them.
+		/// </summary>
+		struct Config {
+			Config() : worker_count(0), pin_workers(false), numa_aware(false), spin_count(32), yield_count(8),
+				background_workers(0), starvation_limit(32), telemetry(false) {}
+			int worker_count;		// 0 for one worker per usable logical processor
+			bool pin_workers;		// bind every worker to a single logical processor
+			bool numa_aware;		// spread the workers over the NUMA nodes and keep each one (and its deque) on its node
+			std::vector<int> cpus;	// OS indices of the logical processors to use, empty for all of them
+			// An idle worker spins (with exponentially more pause instructions each round), then yields,
+			// then sleeps until woken up. Spinning is skipped when there are more workers than processors.
+			int spin_count;			// rounds of spinning
+			int yield_count;		// rounds of yielding
+			int background_workers;	// most workers running background tasks at once, 0 for all but one
+			int starvation_limit;	// interactive tasks a worker takes in a row before a waiting background task
+			bool telemetry;			// measure busy and idle times, which tracing does as well
+		};
+
 		/// <summary>
-		/// Worker thread that gets tasks from the scheduler.
+		/// Worker thread that runs tasks from its own deque, the shared queue, or other workers.
 		/// </summary>
-		class Worker : public std::thread {
+		class Worker {
 		public:
-			Worker(TaskScheduler *scheduler, int id) :
-				std::thread(&Worker::WorkLoop, this),
+			Worker(TaskScheduler *scheduler, int id, const std::vector<int>& affinity) :
 				scheduler_(scheduler),
-				id_(id)
+				id_(id),
+				seed_(2463534242u + 747796405u * uint32_t(id)),
+				affinity_(affinity),
+				pinned_(false),
+				priority_(Priority::Interactive),
+				streak_(0),
+				thread_(&Worker::WorkLoop, this)
 				{}
+			inline int Id() const { return id_; }
+			/// <summary>
+			/// The logical processors the worker may run on (OS indices), empty if it isn't restricted.
+			/// </summary>
+			inline const std::vector<int>& Affinity() const { return affinity_; }
+			/// <summary>
+			/// The processor the worker is pinned to, or -1 if it may run on more than one.
+			/// </summary>
+			inline int Cpu() const { return affinity_.size() == 1 ? affinity_[0] : -1; }
+			/// <summary>
+			/// The NUMA node the worker is kept on, or -1 if it may run on more than one.
+			/// </summary>
+			int Node() const;
+			/// <summary>
+			/// Whether the OS accepted the affinity, valid once the scheduler has started.
+			/// </summary>
+			inline bool Pinned() const { return pinned_; }
+			inline void Join(){ thread_.join(); }
 		private:
 			void WorkLoop();
+			/// <summary>
+			/// Xorshift, used to pick the first victim to steal from.
+			/// </summary>
+			inline uint32_t NextRandom(){
+				seed_ ^= seed_ << 13;
+				seed_ ^= seed_ >> 17;
+				seed_ ^= seed_ << 5;
+				return seed_;
+			}
 		private:
+			friend class TaskScheduler;
 			TaskScheduler *scheduler_;
 			int id_;
+			uint32_t seed_;
+			std::vector<int> affinity_;
+			bool pinned_;
+			Priority priority_;		// of the running task
+			int streak_;			// interactive tasks taken in a row while background tasks were waiting
+			std::unique_ptr<TaskDeque<Task>> tasks_[PRIORITY_COUNT];	// allocated by the worker after pinning, so they are local to its node
+			std::thread thread_;	// started last, after the rest of the worker is ready
 		};
 
 		/// <summary>
-		/// Callable function.
+		/// Callable function: either a function pointer with its arguments, or any callable object
+		/// taking the worker id (or nothing). Callables up to INLINE_SIZE bytes are stored in the task itself,
+		/// larger ones in a pooled block.
 		/// </summary>
 		class Task {
 		public:
 			typedef void(*Func)(void *args, int id);
+			static const size_t INLINE_SIZE = 48;
 
-			Task() : func(nullptr), args(nullptr){}
-			Task(Func func, void *args) : func(func), args(args){}
-			Task(const Task& other) : func(other.func), args(other.args){}
-			inline Task& operator = (const Task& other) { this->func = other.func; this->args = other.args; return *this; }
+			Task() : ops_(nullptr), group(nullptr){}
+			Task(Func func, void *args) : ops_(nullptr), group(nullptr){ Emplace(FuncCall{ func, args }); }
+			template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+			Task(F&& func) : ops_(nullptr), group(nullptr){ Emplace(std::forward<F>(func)); }
+			Task(const Task& other) : ops_(nullptr), group(other.group){ CopyFrom(other); }
+			Task(Task&& other) : ops_(nullptr), group(other.group){ MoveFrom(other); }
+			~Task(){ Reset(); }
+			inline Task& operator = (const Task& other) {
+				if (this != &other){ Reset(); CopyFrom(other); group = other.group; }
+				return *this;
+			}
+			inline Task& operator = (Task&& other) {
+				if (this != &other){ Reset(); MoveFrom(other); group = other.group; }
+				return *this;
+			}
+
+			inline void Run(int id){ ops_->invoke(storage_, id); }
+			inline bool Empty() const { return ops_ == nullptr; }
+
+		private:
+			struct FuncCall {
+				Func func;
+				void *args;
+				inline void operator () (int id) const { func(args, id); }
+			};
+			typedef void(*CopyFunc)(void *dst, const void *src);
+			struct Ops {
+				void(*invoke)(void *storage, int id);
+				CopyFunc copy;		// null if the callable can't be copied
+				void(*move)(void *dst, void *src);
+				void(*destroy)(void *storage);
+			};
+			template<typename F>
+			struct Fits : std::integral_constant<bool,
+				sizeof(F) <= INLINE_SIZE && alignof(F) <= 16 && std::is_nothrow_move_constructible<F>::value> {};
+
+			template<typename F> static auto Call(F& f, int id, int) -> decltype(f(id), void()) { f(id); }
+			template<typename F> static void Call(F& f, int /*id*/, long) { f(); }
+
+			template<typename F>
+			struct InlineOps {
+				static void Invoke(void *storage, int id) { Call(*(F *)storage, id, 0); }
+				static void Copy(void *dst, const void *src) { new (dst) F(*(const F *)src); }
+				static void Move(void *dst, void *src) { new (dst) F(std::move(*(F *)src)); ((F *)src)->~F(); }
+				static void Destroy(void *storage) { ((F *)storage)->~F(); }
+				static const Ops ops;
+			};
+			template<typename F>
+			struct PooledOps {
+				static F *&Get(void *storage) { return *(F **)storage; }
+				static void Invoke(void *storage, int id) { Call(*Get(storage), id, 0); }
+				static void Copy(void *dst, const void *src) { Get(dst) = new (AllocStorage(sizeof(F))) F(*Get(const_cast<void *>(src))); }
+				static void Move(void *dst, void *src) { Get(dst) = Get(src); }
+				static void Destroy(void *storage) { Get(storage)->~F(); FreeStorage(Get(storage), sizeof(F)); }
+				static const Ops ops;
+			};
+			template<typename Impl>
+			static constexpr CopyFunc CopyOf(std::true_type) { return &Impl::Copy; }
+			template<typename Impl>
+			static constexpr CopyFunc CopyOf(std::false_type) { return nullptr; }
+
+			template<typename F>
+			inline void Emplace(F&& func) {
+				typedef typename std::decay<F>::type Callable;
+				static_assert(alignof(Callable) <= 64, "over-aligned callables are not supported");
+				EmplaceImpl<Callable>(std::forward<F>(func), Fits<Callable>());
+			}
+			template<typename C, typename F>
+			inline void EmplaceImpl(F&& func, std::true_type) {
+				new (storage_) C(std::forward<F>(func));
+				ops_ = &InlineOps<C>::ops;
+			}
+			template<typename C, typename F>
+			inline void EmplaceImpl(F&& func, std::false_type) {
+				PooledOps<C>::Get(storage_) = new (AllocStorage(sizeof(C))) C(std::forward<F>(func));
+				ops_ = &PooledOps<C>::ops;
+			}
+			inline void CopyFrom(const Task& other) {
+				if (other.ops_){
+					assert(other.ops_->copy && "the callable of this task can't be copied");
+					other.ops_->copy(storage_, other.storage_);
+					ops_ = other.ops_;
+				}
+			}
+			inline void MoveFrom(Task& other) {
+				if (other.ops_){
+					other.ops_->move(storage_, other.storage_);
+					ops_ = other.ops_;
+					other.ops_ = nullptr;
+				}
+			}
+			inline void Reset() {
+				if (ops_){
+					ops_->destroy(storage_);
+					ops_ = nullptr;
+				}
+			}
+			/// <summary>
+			/// Blocks for callables that don't fit in the task, recycled through per-thread free lists.
+			/// </summary>
+			static void *AllocStorage(size_t size);
+			static void FreeStorage(void *ptr, size_t size);
 
-			inline void Run(int id){ func(args, id); }
 		private:
-			Func func;
-			void *args;
+			friend class TaskScheduler;
+			alignas(16) unsigned char storage_[INLINE_SIZE];
+			const Ops *ops_;
+			TaskGroup *group;	// notified when the task finishes
 		};
 
 
 	private:
-		TaskScheduler() : running_(false) { task_count_ = 0; }
+		TaskScheduler() : running_(false), background_limit_(1), spin_count_(0), started_count_(0) {
+			task_count_ = 0; worker_count_ = 0; sleeping_count_ = 0; background_running_ = 0; helper_seed_ = 0; helper_slot_.clear();
+			for (int lane = 0; lane < PRIORITY_COUNT; lane++){ pending_count_[lane] = 0; injected_count_[lane] = 0; }
+			tracing_ = false; trace_origin_ns_ = 0; last_sample_ns_ = 0;
+			telemetry_.emplace_back(new WorkerTelemetry("helper"));
+		}
 	public:
 		static TaskScheduler *Instance();
 		static void DeleteInstance();
 	public:
 		inline bool Running(){ return running_; }
-		inline int ThreadCount(){ return threads.size(); }
+		inline int ThreadCount(){ return int(workers_.size()); }
+		/// <summary>
+		/// Starts the workers with the configuration of the previous start (the default one at first).
+		/// </summary>
 		void StartAll();
+		/// <summary>
+		/// Starts the workers placed as configured, returns once all of them are ready.
+		/// </summary>
+		void StartAll(const Config& config);
 		void StopAll();
-		void AddTask(Task& newTask);
+		inline const Config& GetConfig() const { return config_; }
+		inline const Worker& GetWorker(int id) const { return *workers_[id]; }
+
+		/// <summary>
+		/// Counters of a worker, or of the threads outside of the pool helping with tasks for id == ThreadCount(),
+		/// since the last StartAll() or ResetStats().
+		/// </summary>
+		inline WorkerStats GetStats(int id) const { return telemetry_[id]->Stats(); }
+		WorkerStats GetTotalStats() const;
+		void ResetStats();
+		inline int PendingCount(Priority priority) const { return pending_count_[int(priority)]; }
+		/// <summary>
+		/// Records every task and idle period of every thread, and samples the queue depths while tasks start.
+		/// </summary>
+		void StartTrace();
+		void StopTrace();
+		inline bool Tracing() const { return tracing_; }
+		/// <summary>
+		/// Writes the events recorded so far as Chrome trace JSON, and discards them.
+		/// </summary>
+		void WriteTrace(std::ostream& out);
+		/// <summary>
+		/// Queues a copy of the task. Tasks added from a worker go to its own deque,
+		/// others go to the shared queue.
+		/// </summary>
+		void AddTask(Task& newTask, Priority priority = Priority::Inherit);
+		void AddTask(Task&& newTask, Priority priority = Priority::Inherit);
+		/// <summary>
+		/// Queues the task as part of the group, with the priority of the group, see TaskGroup::Run().
+		/// </summary>
+		void AddTask(Task& newTask, TaskGroup *group);
+		void AddTask(Task&& newTask, TaskGroup *group);
+		/// <summary>
+		/// Queues copies of count tasks at once, waking up as many sleeping workers as needed with a single lock.
+		/// </summary>
+		void AddTasks(const Task *tasks, size_t count, TaskGroup *group = nullptr);
+		inline void AddTasks(const std::vector<Task>& tasks, TaskGroup *group = nullptr) { AddTasks(tasks.data(), tasks.size(), group); }
+		/// <summary>
+		/// Waits for every task of the scheduler, helping while there are tasks to take.
+		/// </summary>
 		void JoinAll();
+		/// <summary>
+		/// Runs one queued task on the calling thread.
+		/// Workers pass their own id to the task; one thread outside of the pool at a time may help as well,
+		/// passing ThreadCount() as the id. Returns false if no task was run.
+		/// </summary>
+		bool TryRunTask();
+		inline bool IsWorkerThread() const { return current_worker_ && current_worker_->scheduler_ == this; }
+		/// <summary>
+		/// The id the calling thread passes to the tasks it runs: its worker id, or ThreadCount() outside of the pool.
+		/// </summary>
+		inline int CurrentThreadId() const { return IsWorkerThread() ? current_worker_->id_ : int(workers_.size()); }
+		/// <summary>
+		/// The priority of the task running on the calling thread, which the tasks it adds inherit.
+		/// </summary>
+		inline Priority CurrentPriority() const { return IsWorkerThread() ? current_worker_->priority_ : Priority::Interactive; }
 
-	public:
-		std::deque<Task> tasks;
-		std::vector<Worker> threads;
+	private:
+		inline Priority Resolve(Priority priority) const { return priority == Priority::Inherit ? CurrentPriority() : priority; }
+		/// <summary>
+		/// Finds a task for the worker, interactive ones first unless background ones have waited too long.
+		/// </summary>
+		Task *TakeTask(Worker *worker, Priority& priority);
+		/// <summary>
+		/// Takes a task of one lane: from the worker's own deque (the worker may be null), then the shared queue,
+		/// then the other workers. Background tasks need a free background slot, unless the thread already holds one.
+		/// </summary>
+		Task *TakeFrom(Worker *worker, Priority priority);
+		Task *TakeInjected(int lane);
+		void Submit(Task *task, TaskGroup *group, Priority priority);
+		/// <summary>
+		/// Tries every worker except the thief (which may be null) once, starting from a random one.
+		/// </summary>
+		Task *Steal(Worker *thief, int lane, uint32_t random);
+		void RunTask(Task *task, int id, Priority priority);
+		bool AcquireBackgroundSlot();
+		void ReleaseBackgroundSlot();
+		/// <summary>
+		/// Whether an idle worker could take a task now.
+		/// </summary>
+		inline bool HasWork() const {
+			return pending_count_[int(Priority::Interactive)] > 0 ||
+				(pending_count_[int(Priority::Background)] > 0 && background_running_ < background_limit_);
+		}
+		/// <summary>
+		/// Waits for queued tasks as configured: spins, then yields, then parks. Returns whether it parked.
+		/// </summary>
+		bool Idle();
+		/// <summary>
+		/// Blocks the calling worker until there are queued tasks or the scheduler stops.
+		/// Returns whether it had to wait.
+		/// </summary>
+		bool Park();
+		void WakeOne();
+		void Wake(int count);
+		/// <summary>
+		/// Called by every worker once it is ready to take tasks.
+		/// </summary>
+		void WorkerStarted();
+		inline bool Timed() const { return config_.telemetry || tracing_; }
+		/// <summary>
+		/// Counters of the calling thread: its worker's, or the ones of the helping threads.
+		/// </summary>
+		inline WorkerTelemetry& ThreadTelemetry(Worker *worker) { return *telemetry_[worker ? worker->id_ : workers_.size()]; }
+		void SampleQueueDepth(int64_t now_ns);
+		static const int64_t SAMPLE_INTERVAL_NS = 100000;
 
 	private:
 		static TaskScheduler *instance;
+		static thread_local Worker *current_worker_;
+		static thread_local TaskScheduler *current_helper_;	// scheduler whose extra slot this thread holds
 		std::atomic_bool running_;
-		std::atomic_int task_count_;
+		std::atomic_int task_count_;		// tasks added but not finished
+		std::atomic_int worker_count_;		// workers visible to thieves
+		std::atomic_int pending_count_[PRIORITY_COUNT];	// tasks added but not started
+		std::atomic_int injected_count_[PRIORITY_COUNT];	// size of the shared queues
+		std::atomic_int background_running_;	// threads running background tasks
+		int background_limit_;
+		std::atomic_int sleeping_count_;	// parked workers
+		std::atomic_flag helper_slot_;		// held by the thread outside of the pool that is helping
+		std::atomic<uint32_t> helper_seed_;
+
+		Config config_;
+		int spin_count_;					// config_.spin_count, or 0 if the workers share processors
+		std::vector<std::unique_ptr<Worker>> workers_;
+		int started_count_;					// workers ready, guarded by start_mutex_
+		std::mutex start_mutex_;
+		std::condition_variable started_cv_;
 
 		std::mutex tasks_mutex_;
+		std::deque<Task *> injected_tasks_[PRIORITY_COUNT];	// tasks added from outside the workers
+
+		std::mutex sleep_mutex_;
 		std::condition_variable task_available_cv_;
 
 		std::mutex finished_mutex_;
-		std::condition_variable task_finished_cv_;	// the completion of one task
+		std::condition_variable task_finished_cv_;	// the completion of all tasks
+
+		std::vector<std::unique_ptr<WorkerTelemetry>> telemetry_;	// one per worker, and one for the helping threads
+		std::atomic_bool tracing_;
+		int64_t trace_origin_ns_;
+		std::atomic<int64_t> last_sample_ns_;
+		std::mutex samples_mutex_;
+		std::vector<QueueDepthSample> samples_;
+	};
+
+	/// <summary>
+	/// A set of tasks that can be waited for independently of the other tasks of the scheduler.
+	/// Tasks of a group may add more tasks to the same group while running.
+	/// </summary>
+	class TaskGroup : NonCopyable {
+	public:
+		TaskGroup(TaskScheduler *scheduler = TaskScheduler::Instance()) :
+			scheduler_(scheduler), priority_(TaskScheduler::Priority::Inherit), count_(0) {}
+		/// <summary>
+		/// A group whose tasks run with the given priority instead of the one of the thread adding them.
+		/// </summary>
+		TaskGroup(TaskScheduler::Priority priority, TaskScheduler *scheduler = TaskScheduler::Instance()) :
+			scheduler_(scheduler), priority_(priority), count_(0) {}
+		/// <summary>
+		/// Waits for the remaining tasks, so that no task outlives the group.
+		/// </summary>
+		~TaskGroup() { Wait(); }
+
+		inline void Run(TaskScheduler::Task& task) { scheduler_->AddTask(task, this); }
+		inline void Run(TaskScheduler::Task&& task) { scheduler_->AddTask(std::move(task), this); }
+		inline void Run(TaskScheduler::Task::Func func, void *args) { Run(TaskScheduler::Task(func, args)); }
+		inline void Run(const TaskScheduler::Task *tasks, size_t count) { scheduler_->AddTasks(tasks, count, this); }
+		/// <summary>
+		/// Runs queued tasks (of any group) on the calling thread until every task of this group is finished,
+		/// then blocks if there is nothing left to help with. The group can be reused afterwards.
+		/// </summary>
+		void Wait();
+		inline int Count() const { return count_; }
+		inline TaskScheduler::Priority GetPriority() const { return priority_; }
+	private:
+		friend class TaskScheduler;
+		inline void Add(int count = 1) { count_ += count; }
+		void Finish();
+	private:
+		TaskScheduler *scheduler_;
+		TaskScheduler::Priority priority_;
+		std::atomic_int count_;
+		std::mutex mutex_;
+		std::condition_variable finished_cv_;
+	};
+
+	template<typename F>
+	const TaskScheduler::Task::Ops TaskScheduler::Task::InlineOps<F>::ops = {
+		&InlineOps<F>::Invoke,
+		Task::CopyOf<InlineOps<F>>(std::is_copy_constructible<F>()),
+		&InlineOps<F>::Move,
+		&InlineOps<F>::Destroy
+	};
+	template<typename F>
+	const TaskScheduler::Task::Ops TaskScheduler::Task::PooledOps<F>::ops = {
+		&PooledOps<F>::Invoke,
+		Task::CopyOf<PooledOps<F>>(std::is_copy_constructible<F>()),
+		&PooledOps<F>::Move,
+		&PooledOps<F>::Destroy
 	};
 }
@@ -6,6 +6,7 @@
 #include "gtest/gtest.h"
 #include "txbase/math/vector.h"
 #include "txbase/math/matrix.h"
+#include "txbase/math/affine.h"
 #include "txbase/math/quaternion.h"
 #include "txbase/math/color.h"
 #include "txbase/sse/sse.h"
@@ -71,9 +72,15 @@ namespace TX
 					Assertions::Near(expected.t_max, actual.t_max);
 				}
 			}
+			inline void Near(const Matrix3x3& expected, const Matrix3x3& actual){
+				Assertions::VNear<Matrix3x3, 3>(expected, actual);
+			}
 			inline void Near(const Matrix4x4& expected, const Matrix4x4& actual){
 				Assertions::VNear<Matrix4x4, 4>(expected, actual);
 			}
+			inline void Near(const AffineTransform& expected, const AffineTransform& actual){
+				Assertions::VNear<AffineTransform, 3>(expected, actual);
+			}
 			inline void Near(const Quaternion& expected, const Quaternion& actual) {
 #define signof(f) ((f) >= 0 ? 1 : -1)
 				// might get a negative version, but they are still equivalent
@@ -97,6 +104,31 @@ namespace TX
 			inline void Near(const SSE::V4Float& expected, const SSE::V4Float& actual) {
 				Assertions::VNear<SSE::V4Float, 4>(expected, actual);
 			}
+#ifdef __AVX2__
+			inline void Equal(const SSE::V8Bool& expected, const SSE::V8Bool& actual) {
+				Assertions::VEqual<SSE::V8Bool, 8>(expected, actual);
+			}
+			inline void Equal(const SSE::V8Int& expected, const SSE::V8Int& actual) {
+				Assertions::VEqual<SSE::V8Int, 8>(expected, actual);
+			}
+			inline void Equal(const SSE::V8Float& expected, const SSE::V8Float& actual) {
+				Assertions::VEqual<SSE::V8Float, 8>(expected, actual);
+			}
+			inline void Near(const SSE::V8Float& expected, const SSE::V8Float& actual) {
+				Assertions::VNear<SSE::V8Float, 8>(expected, actual);
+			}
+#endif
+#ifdef __AVX512F__
+			inline void Equal(const SSE::V16Int& expected, const SSE::V16Int& actual) {
+				Assertions::VEqual<SSE::V16Int, 16>(expected, actual);
+			}
+			inline void Equal(const SSE::V16Float& expected, const SSE::V16Float& actual) {
+				Assertions::VEqual<SSE::V16Float, 16>(expected, actual);
+			}
+			inline void Near(const SSE::V16Float& expected, const SSE::V16Float& actual) {
+				Assertions::VNear<SSE::V16Float, 16>(expected, actual);
+			}
+#endif
 
 
 			template<typename T, size_t N>
@@ -0,0 +1,72 @@
+#include "txbase_tests/helper.h"
+#include "txbase/math/affine.h"
+#include "txbase/math/transform.h"
+
+namespace TX
+{
+	namespace Tests
+	{
+		namespace {
+			Matrix4x4 Example(){
+				return Matrix4x4::Translate(1, -2, 3) * Matrix4x4::Rotate(0.3f, -1.1f, 0.7f) * Matrix4x4::Scale(2, 0.5f, 3);
+			}
+		}
+
+		TEST(AffineTransformTests, Operator_Multiply) {
+			Matrix4x4 a = Example();
+			Matrix4x4 b = Matrix4x4::Translate(-4, 0, 1) * Matrix4x4::Rotate(1.2f, Vec3(1, 1, 0));
+			Assertions::Near(AffineTransform(a * b), AffineTransform(a) * AffineTransform(b));
+			AffineTransform c(a);
+			c *= c;
+			Assertions::Near(AffineTransform(a * a), c);
+		}
+
+		TEST(AffineTransformTests, Inverse) {
+			AffineTransform example(Example());
+			Assertions::Near(AffineTransform(Example().Inverse()), example.Inverse());
+			Assertions::Near(AffineTransform::IDENTITY, example * example.Inverse());
+			Assertions::Near(Example().Inverse(), Example().InverseAffine());
+		}
+
+		TEST(AffineTransformTests, InverseSingular) {
+			// the third row is the sum of the first two
+			const Matrix3x3 m(Vec3(1, 2, 3), Vec3(-1, 0, 2), Vec3(0, 2, 5));
+			Assertions::Near(Matrix3x3::IDENTITY, m.Inverse());
+			const AffineTransform a(Matrix4x4::Translate(1, -2, 3) * Matrix4x4::Scale(2, 0, 3));
+			Assertions::Near(AffineTransform::IDENTITY, a.Inverse());
+		}
+
+		TEST(AffineTransformTests, Transform) {
+			Matrix4x4 m = Example();
+			AffineTransform a(m), a_inv = a.Inverse();
+			std::vector<Vec3> in;
+			for (int i = 0; i < 11; i++)
+				in.push_back(Vec3(float(i), 3.f - i, 0.25f * i));
+			std::vector<Vec3> points(in.size()), vecs(in.size()), normals(in.size());
+			AffineTransform::TPoints(a, in.data(), points.data(), in.size());
+			AffineTransform::TVecs(a, in.data(), vecs.data(), in.size());
+			AffineTransform::TNormals(a_inv, in.data(), normals.data(), in.size());
+			for (size_t i = 0; i < in.size(); i++){
+				Assertions::Near(Matrix4x4::TPoint(m, in[i]), AffineTransform::TPoint(a, in[i]));
+				Assertions::Near(Matrix4x4::TVec(m, in[i]), AffineTransform::TVec(a, in[i]));
+				Assertions::Near(Matrix4x4::TNormal(m.Inverse(), in[i]), AffineTransform::TNormal(a_inv, in[i]));
+				Assertions::Near(Matrix4x4::TPoint(m, in[i]), points[i]);
+				Assertions::Near(Matrix4x4::TVec(m, in[i]), vecs[i]);
+				Assertions::Near(Matrix4x4::TNormal(m.Inverse(), in[i]), normals[i]);
+			}
+		}
+
+		TEST(AffineTransformTests, TransformCache) {
+			Transform transform;
+			transform.SetPosition(Vec3(1, 2, 3)).SetRotation(Quaternion::Euler(30, 45, 10)).SetScale(Vec3(2, 1, 0.5f));
+			transform.UpdateMatrix();
+			const Matrix4x4 expected = Matrix4x4::Translate(Vec3(1, 2, 3))
+				* Quaternion::Euler(30, 45, 10).RotationMatrix4x4()
+				* Matrix4x4::Scale(Vec3(2, 1, 0.5f));
+			Assertions::Near(expected, transform.LocalToWorldMatrix());
+			Assertions::Near(expected.Inverse(), transform.WorldToLocalMatrix());
+			Assertions::Near(Matrix3x3(expected).Inverse().Transpose(), transform.NormalMatrix());
+			EXPECT_EQ(48u, sizeof(AffineTransform));
+		}
+	}
+}
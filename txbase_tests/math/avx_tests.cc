@@ -0,0 +1,156 @@
+#include "txbase_tests/helper.h"
+
+#ifdef __AVX2__
+namespace TX
+{
+	using namespace SSE;
+	namespace Tests
+	{
+		TEST(V8FloatTests, Constructor) {
+			V8Float f8(1, 2, 3, 4, 5, 6, 7, 8);
+			for (int i = 0; i < 8; i++)
+				Assertions::Near(float(i + 1), f8[i]);
+			Assertions::Near(V8Float(1), V8Float(1, 1, 1, 1, 1, 1, 1, 1));
+			Assertions::Near(f8, V8Float(V4Float(1, 2, 3, 4), V4Float(5, 6, 7, 8)));
+			Assertions::Near(V4Float(5, 6, 7, 8), f8.High());
+			float arr[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+			Assertions::Equal(f8, V8Float(arr));
+			Assertions::Equal(V8Float(2, 1, 4, 3, 6, 5, 8, 7), Shuffle<1, 0, 3, 2>(f8));
+		}
+
+		TEST(V8FloatTests, Operators) {
+			V8Float a(2, 4, 6, 8, 10, 12, 14, 16);
+			V8Float b(-1, -2, -3, -4, -5, -6, -7, -8);
+			Assertions::Near(V8Float(1, 2, 3, 4, 5, 6, 7, 8), a + b);
+			Assertions::Near(V8Float(3, 6, 9, 12, 15, 18, 21, 24), a - b);
+			Assertions::Near(V8Float(-2, -8, -18, -32, -50, -72, -98, -128), a * b);
+			Assertions::Equal(V8Float(-2), a / b);
+			Assertions::Equal(V8Float(-2, -4, -6, -8, -10, -12, -14, -16), -a);
+			a += b;
+			Assertions::Near(V8Float(1, 2, 3, 4, 5, 6, 7, 8), a);
+			EXPECT_TRUE(All(a == V8Float(1, 2, 3, 4, 5, 6, 7, 8)));
+			EXPECT_TRUE(Any(a != V8Float(1, 2, 3, 4, 5, 6, 7, 9)));
+			Assertions::Equal(V8Bool(true, true, false, false, false, false, false, false), a < 3.f);
+			Assertions::Equal(V8Bool(false, false, false, false, false, false, true, true), a >= 7.f);
+		}
+
+		TEST(V8FloatTests, Math) {
+			V8Float v(-1.5f, -0.5f, 0, 0.5f, 1.5f, 2, -2, 3);
+			Assertions::Equal(V8Float(1.5f, 0.5f, 0, 0.5f, 1.5f, 2, 2, 3), Abs(v));
+			Assertions::Equal(V8Float(-2, -1, 0, 0, 1, 2, -2, 3), Floor(v));
+			Assertions::Equal(V8Float(-1, -0, 0, 1, 2, 2, -2, 3), Ceil(v));
+			Assertions::Near(V8Float(1, 2.71828f, 0.367879f, 7.38905f, 1, 2.71828f, 0.367879f, 7.38905f),
+				Exp(V8Float(0, 1, -1, 2, 0, 1, -1, 2)));
+			V8Float rad(0, 1.570796f, 3.141592f, 4.188790f, 0, 1.570796f, 3.141592f, 4.188790f);
+			Assertions::Near(V8Float(0, 1, 0, -0.866025f, 0, 1, 0, -0.866025f), Sin(rad));
+			Assertions::Near(V8Float(1, 0, -1, -0.5f, 1, 0, -1, -0.5f), Cos(rad));
+			Assertions::Near(V8Float(7, 10, 13, 16, 19, 22, 25, 28), MulAdd(V8Float(1, 2, 3, 4, 5, 6, 7, 8), V8Float(3), V8Float(4)));
+			Assertions::Near(V8Float(1), NegMulAdd(V8Float(2), V8Float(3), V8Float(7)));
+			Assertions::Near(V4Float(5), MulSub(V4Float(2), V4Float(3), V4Float(1)));
+		}
+
+		TEST(V8FloatTests, Reduce) {
+			V8Float v(4, 7, -2, 9, 1, -5, 3, 0);
+			EXPECT_EQ(-5.f, ReduceMin(v));
+			EXPECT_EQ(9.f, ReduceMax(v));
+			EXPECT_EQ(17.f, ReduceAdd(v));
+			EXPECT_EQ(5, SelectMin(v));
+			EXPECT_EQ(3, SelectMax(v));
+			V8Bool valid(true, true, true, false, true, false, true, true);
+			EXPECT_EQ(2, SelectMin(valid, v));
+			EXPECT_EQ(1, SelectMax(valid, v));
+			Assertions::Equal(V8Float(4, 7, -2, 0, 1, 0, 3, 0), Select(valid, v, V8Float::ZERO));
+		}
+
+		TEST(V8IntTests, Operators) {
+			V8Int a(1, 2, 3, 4, 5, 6, 7, 8);
+			Assertions::Equal(V8Int(2, 4, 6, 8, 10, 12, 14, 16), a + a);
+			Assertions::Equal(V8Int(1, 4, 9, 16, 25, 36, 49, 64), a * a);
+			Assertions::Equal(V8Int(2, 4, 6, 8, 10, 12, 14, 16), a << 1);
+			Assertions::Equal(V8Int(-1, -2, -3, -4, -5, -6, -7, -8), -a);
+			Assertions::Equal(V8Int(1, 2, 3, 4, 5, 6, 7, 8), Abs(-a));
+			Assertions::Equal(V8Int(1, 2, 3, 4, 4, 4, 4, 4), Min(a, V8Int(4)));
+			Assertions::Equal(V8Bool(false, false, false, false, true, true, true, true), a > 4);
+			Assertions::Equal(V8Bool(true, true, true, true, false, false, false, false), a <= 4);
+			Assertions::Equal(V4Int(a.High()), V4Int(_mm_setr_epi32(5, 6, 7, 8)));
+			const int32_t sign = INT32_MIN;		// flipped like V4Int's, not negated
+			Assertions::Equal(a ^ V8Int(sign, 0, sign, 0, sign, 0, sign, 0), Negate<true, false, true, false, true, false, true, false>(a));
+			Assertions::Equal(V8Int(1, 2, 3, 4, 5, 6, 7, 8), V8Int(V8Float(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f)));
+		}
+
+		TEST(V8BoolTests, Logic) {
+			V8Bool a(true, false, true, false, true, false, true, false);
+			V8Bool b(true, true, false, false, true, true, false, false);
+			Assertions::Equal(V8Bool(true, false, false, false, true, false, false, false), a & b);
+			Assertions::Equal(V8Bool(true, true, true, false, true, true, true, false), a | b);
+			Assertions::Equal(V8Bool(false, true, true, false, false, true, true, false), a ^ b);
+			Assertions::Equal(V8Bool(false, true, false, true, false, true, false, true), !a);
+			EXPECT_TRUE(All(a == a));
+			EXPECT_TRUE(None(a != a));
+			EXPECT_TRUE(Any(a));
+			EXPECT_FALSE(All(a));
+			EXPECT_TRUE(None(V8Bool(false)));
+			EXPECT_EQ(0x55, _mm256_movemask_ps(a));
+		}
+
+		TEST(V8FloatTests, Vec3) {
+			Vec3V8F a(V8Float(1)), b(V8Float(2));
+			a[1] = V8Float(0, 1, 2, 3, 4, 5, 6, 7);
+			Vec3V8F sum;
+			Assertions::Equal(V8Float::ZERO, sum.z);
+			sum = a + b;
+			Assertions::Near(V8Float(3), sum[0]);
+			Assertions::Near(V8Float(2, 3, 4, 5, 6, 7, 8, 9), sum[1]);
+		}
+	}
+}
+#endif
+
+#ifdef __AVX512F__
+namespace TX
+{
+	using namespace SSE;
+	namespace Tests
+	{
+		TEST(V16FloatTests, Operators) {
+			float arr[16];
+			for (int i = 0; i < 16; i++)
+				arr[i] = float(i + 1);
+			V16Float a(arr);
+			Assertions::Equal(V8Float(9, 10, 11, 12, 13, 14, 15, 16), a.High());
+			Assertions::Equal(V16Float(a.Low(), a.High()), a);
+			for (int i = 0; i < 16; i++){
+				EXPECT_EQ(2.f * (i + 1), (a + a)[i]);
+				EXPECT_EQ(-float(i + 1), (-a)[i]);
+				EXPECT_EQ(float(i + 1), Abs(-a)[i]);
+			}
+			EXPECT_EQ(0x00FF, (a <= 8.f).m);
+			EXPECT_TRUE(All(a == a));
+			EXPECT_TRUE(None(a != a));
+			EXPECT_EQ(136.f, ReduceAdd(a));
+			EXPECT_EQ(16.f, ReduceMax(a));
+			EXPECT_EQ(0, SelectMin(a));
+			EXPECT_EQ(8, SelectMin(a > 8.f, a));
+			Assertions::Equal(V16Float::ONE, Select(a > 8.f, V16Float::ZERO, V16Float::ONE) + Select(a > 8.f, V16Float::ONE, V16Float::ZERO));
+			Assertions::Near(V16Float(7.f), MulAdd(V16Float(2.f), V16Float(3.f), V16Float(1.f)));
+			Assertions::Near(V16Float::ZERO, Sin(V16Float::ZERO));
+		}
+
+		TEST(V16IntTests, Operators) {
+			V16Int a(V8Int(1, 2, 3, 4, 5, 6, 7, 8), V8Int(9, 10, 11, 12, 13, 14, 15, 16));
+			Assertions::Equal(V8Int(9, 10, 11, 12, 13, 14, 15, 16), a.High());
+			for (int i = 0; i < 16; i++){
+				EXPECT_EQ((i + 1) * (i + 1), (a * a)[i]);
+				EXPECT_EQ(-(i + 1), (-a)[i]);
+				EXPECT_EQ(Math::Min(i + 1, 4), Min(a, V16Int(4))[i]);
+			}
+			EXPECT_EQ(0xFFF0, (a > 4).m);
+			V16Bool mask(V8Bool(true), V8Bool(false));
+			EXPECT_EQ(0x00FF, mask.m);
+			EXPECT_TRUE(Any(mask));
+			EXPECT_FALSE(All(mask));
+			EXPECT_EQ(0xFF00, (!mask).m);
+		}
+	}
+}
+#endif
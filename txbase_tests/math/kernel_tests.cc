@@ -0,0 +1,202 @@
+#include "txbase_tests/helper.h"
+#include "txbase/sse/kernels.h"
+#include "txbase/shape/mesh.h"
+#include "txbase/scene/camera.h"
+#include "txbase/sys/memory.h"
+#include <random>
+
+namespace TX
+{
+	namespace Tests
+	{
+		namespace {
+			std::vector<SimdLevel> SupportedLevels(){
+				std::vector<SimdLevel> levels;
+				for (SimdLevel level : { SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 }){
+					if (CpuFeatures::Get().Supports(level))
+						levels.push_back(level);
+				}
+				return levels;
+			}
+		}
+
+		TEST(CpuFeaturesTests, Level) {
+			const CpuFeatures& features = CpuFeatures::Get();
+			EXPECT_TRUE(features.sse41);
+			EXPECT_TRUE(features.Supports(features.Level()));
+			EXPECT_EQ(features.Level(), Kernels().level);
+			if (features.avx2) {
+				EXPECT_TRUE(features.avx);
+			}
+		}
+
+		TEST(KernelTests, ScaleColors) {
+			std::mt19937 rng(7);
+			std::uniform_real_distribution<float> uniform;
+			const int count = 45;
+			std::vector<Color> in(count), expected(count);
+			std::vector<float> weights(count);
+			for (int i = 0; i < count; i++){
+				in[i] = Color(uniform(rng), uniform(rng) * 4, uniform(rng) * 9, uniform(rng));
+				weights[i] = uniform(rng) * 3;
+				expected[i] = in[i] / weights[i];
+			}
+			for (SimdLevel level : SupportedLevels()){
+				SCOPED_TRACE(int(level));
+				std::vector<Color> out(count);
+				Kernels(level).ScaleColors(out.data(), in.data(), weights.data(), count);
+				for (int i = 0; i < count; i++){
+					Assertions::Equal(expected[i], out[i]);
+					EXPECT_EQ(expected[i].a, out[i].a);
+				}
+			}
+			// large enough to be streamed
+			const int large = int(STREAM_STORE_BYTES / sizeof(Color)) + 5;
+			std::unique_ptr<Color[], AlignedDeleter> big_in(AllocAligned<Color>(large)), big_out(AllocAligned<Color>(large));
+			std::unique_ptr<float[], AlignedDeleter> big_weights(AllocAligned<float>(large));
+			for (int i = 0; i < large; i++){
+				big_in[i] = in[i % count];
+				big_weights[i] = weights[i % count];
+			}
+			for (SimdLevel level : SupportedLevels()){
+				SCOPED_TRACE(int(level));
+				Kernels(level).ScaleColors(big_out.get(), big_in.get(), big_weights.get(), large);
+				for (int i = 0; i < large; i += 97)
+					Assertions::Equal(expected[i % count], big_out[i]);
+				Assertions::Equal(expected[(large - 1) % count], big_out[large - 1]);
+			}
+		}
+
+		TEST(KernelTests, QuantizeFloats) {
+			std::mt19937 rng(11);
+			std::uniform_real_distribution<float> uniform;
+			std::vector<float> in = { -1.f, -0.001f, 0.f, 0.5f / 255, 1.5f / 255, 0.5f, 1.f, 1.001f, 7.f, NAN };
+			while (in.size() < 75)
+				in.push_back(uniform(rng) * 1.2f - 0.1f);
+			for (SimdLevel level : SupportedLevels()){
+				SCOPED_TRACE(int(level));
+				std::vector<unsigned char> out(in.size());
+				Kernels(level).QuantizeFloats(out.data(), in.data(), int(in.size()));
+				for (size_t i = 0; i < in.size(); i++){
+					int expected = std::isnan(in[i]) ? 0 : Math::Clamp(Math::Round(in[i] * 255), 0, 255);
+					EXPECT_EQ(expected, int(out[i])) << "input " << in[i];
+				}
+			}
+		}
+
+		TEST(KernelTests, TransformPoints) {
+			std::mt19937 rng(13);
+			std::uniform_real_distribution<float> uniform;
+			const int count = 29;
+			const Matrix4x4 m = Matrix4x4::Translate(1, -2, 3) * Matrix4x4::Rotate(0.3f, 1.1f, -0.7f) * Matrix4x4::Scale(2, 1, 0.5f);
+			std::vector<Vec3> in(count);
+			for (auto& p : in)
+				p = Vec3(uniform(rng), uniform(rng), uniform(rng)) * 10 - Vec3(5);
+			for (SimdLevel level : SupportedLevels()){
+				SCOPED_TRACE(int(level));
+				std::vector<Vec3> out(count);
+				Kernels(level).TransformPoints(out.data(), m, in.data(), count);
+				for (int i = 0; i < count; i++)
+					Assertions::Near(Matrix4x4::TPoint(m, in[i]), out[i]);
+				// in place
+				out = in;
+				Kernels(level).TransformPoints(out.data(), m, out.data(), count);
+				for (int i = 0; i < count; i++)
+					Assertions::Near(Matrix4x4::TPoint(m, in[i]), out[i]);
+			}
+		}
+
+		TEST(KernelTests, MeshTransform) {
+			Mesh mesh;
+			mesh.LoadSphere(1.f, 13, 7);
+			const std::vector<Vec3> vertices(mesh.vertices.begin(), mesh.vertices.end());
+			const std::vector<Vec3> normals(mesh.normals.begin(), mesh.normals.end());
+			Transform transform;
+			transform.SetPosition(Vec3(1, 2, 3)).SetRotation(Quaternion::Euler(30, 45, 10)).SetScale(Vec3(2, 1, 0.5f));
+			mesh.ApplyTransform(transform);
+			const Matrix4x4& local2world = transform.LocalToWorldMatrix();
+			const Matrix4x4& world2local = transform.WorldToLocalMatrix();
+			for (size_t i = 0; i < vertices.size(); i++){
+				Assertions::Near(Matrix4x4::TPoint(local2world, vertices[i]), mesh.vertices[i]);
+				Assertions::Near(Math::Normalize(Matrix4x4::TNormal(world2local, normals[i])), mesh.normals[i]);
+			}
+		}
+
+		TEST(KernelTests, CameraRays) {
+			Camera camera(64, 48, 60.f);
+			camera.transform.SetPosition(Vec3(1, 2, 3)).SetRotation(Quaternion::Euler(10, 20, 30));
+			camera.transform.UpdateMatrix();
+			std::vector<float> xs, ys;
+			for (int y = 0; y < camera.Height(); y += 5){
+				for (int x = 0; x < camera.Width(); x += 3){
+					xs.push_back(x + 0.5f);
+					ys.push_back(y + 0.25f);
+				}
+			}
+			std::vector<Ray> rays(xs.size());
+			camera.GenerateRays(rays.data(), xs.data(), ys.data(), int(xs.size()));
+			for (size_t i = 0; i < xs.size(); i++){
+				Ray expected;
+				camera.GenerateRay(&expected, xs[i], ys[i]);
+				Assertions::Near(expected.origin, rays[i].origin);
+				Assertions::Near(expected.dir, rays[i].dir);
+				EXPECT_EQ(expected.t_max, rays[i].t_max);
+			}
+		}
+
+		TEST(KernelTests, IntersectTriangles) {
+			std::mt19937 rng(17);
+			std::uniform_real_distribution<float> uniform;
+			Mesh mesh;
+			const int tri_count = 37;
+			for (int i = 0; i < tri_count * 3; i++){
+				mesh.vertices.push_back(Vec3(uniform(rng), uniform(rng), uniform(rng)) * 2 - Vec3(1));
+				mesh.indices.push_back(i);
+			}
+			std::vector<uint32_t> tri_ids;
+			for (int i = tri_count - 1; i >= 0; i -= 2)
+				tri_ids.push_back(i);
+			int hits = 0;
+			for (int r = 0; r < 200; r++){
+				const Vec3 origin = Vec3(uniform(rng), uniform(rng), uniform(rng)) * 10 - Vec3(5);
+				const Vec3 target = Vec3(uniform(rng), uniform(rng), uniform(rng)) - Vec3(0.5f);
+				const Ray expected(origin, target - origin);
+				int expected_hit = -1;
+				for (int i = 0; i < int(tri_ids.size()); i++){
+					if (mesh.Intersect(tri_ids[i], expected))
+						expected_hit = i;
+				}
+				hits += expected_hit >= 0;
+				for (SimdLevel level : SupportedLevels()){
+					SCOPED_TRACE(int(level));
+					const Ray ray(origin, target - origin);
+					int hit = Kernels(level).IntersectTriangles(mesh.vertices.data(), mesh.indices.data(), tri_ids.data(), int(tri_ids.size()), ray);
+					EXPECT_EQ(expected_hit, hit);
+					if (expected_hit >= 0)
+						Assertions::Near(expected.t_max, ray.t_max);
+					else
+						EXPECT_EQ(expected.t_max, ray.t_max);
+				}
+			}
+			EXPECT_LT(0, hits);
+			EXPECT_EQ(-1, mesh.Intersect(tri_ids.data(), 0, Ray()));
+		}
+
+		TEST(KernelTests, IntersectTrianglesOutsideEdge) {
+			// (0.8, 0.8) lies in the parallelogram spanned by e1 and e2 but past the v0-opposite edge
+			Mesh mesh;
+			mesh.vertices = { Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0) };
+			mesh.indices = { 0, 1, 2 };
+			const uint32_t tri_id = 0;
+			const Ray outside(Vec3(0.8f, 0.8f, 1), Vec3(0, 0, -1));
+			EXPECT_FALSE(mesh.Intersect(tri_id, outside));
+			const Ray inside(Vec3(0.4f, 0.4f, 1), Vec3(0, 0, -1));
+			EXPECT_TRUE(mesh.Intersect(tri_id, inside));
+			for (SimdLevel level : SupportedLevels()){
+				SCOPED_TRACE(int(level));
+				EXPECT_EQ(-1, Kernels(level).IntersectTriangles(mesh.vertices.data(), mesh.indices.data(), &tri_id, 1, Ray(Vec3(0.8f, 0.8f, 1), Vec3(0, 0, -1))));
+				EXPECT_EQ(0, Kernels(level).IntersectTriangles(mesh.vertices.data(), mesh.indices.data(), &tri_id, 1, Ray(Vec3(0.4f, 0.4f, 1), Vec3(0, 0, -1))));
+			}
+		}
+	}
+}
@@ -1,10 +1,24 @@
 #include "txbase_tests/helper.h"
 #include "txbase/math/matrix.h"
+#include "txbase/sse/soa.h"
 
 namespace TX
 {
 	namespace Tests
 	{
+		TEST(Matrix3x3Tests, Inverse) {
+			Matrix3x3 example(
+				1, 2, 3,
+				0, 1, 4,
+				5, 6, 0);
+			Matrix3x3 inverse(
+				-24, 18, 5,
+				20, -15, -4,
+				-5, 4, 1);
+			Assertions::Near(inverse, example.Inverse());
+			Assertions::Near(Matrix3x3::IDENTITY, example * example.Inverse());
+		}
+
 		TEST(Matrix4x4Tests, Operator_Multiply) {
 			Matrix4x4 a(
 				1, 2, 3, 4,
@@ -23,6 +37,20 @@ namespace TX
 				2, 2, 2, 2);
 			Assertions::Near(expected, a * b);
 		}
+		TEST(Matrix4x4Tests, Operator_MultiplyAssign) {
+			Matrix4x4 a(
+				1, 2, 0, 1,
+				0, 1, 3, 0,
+				2, 0, 1, 0,
+				0, 0, 0, 1);
+			Matrix4x4 expected(
+				1, 4, 6, 2,
+				6, 1, 6, 0,
+				4, 4, 1, 2,
+				0, 0, 0, 1);
+			a *= a;
+			Assertions::Near(expected, a);
+		}
 		TEST(Matrix4x4Tests, Inverse) {
 			Matrix4x4 example(
 				1, 2, 3, 4,
@@ -38,6 +66,21 @@ namespace TX
 			Assertions::Near(inverse, actual);
 		}
 
+		TEST(Matrix4x4Tests, InverseAffine) {
+			Matrix4x4 example = Matrix4x4::Translate(1, -2, 3) * Matrix4x4::Rotate(0.3f, -1.1f, 0.7f) * Matrix4x4::Scale(2, 0.5f, 3);
+			Assertions::Near(example.Inverse(), example.InverseAffine());
+			Assertions::Near(Matrix4x4::IDENTITY, example * example.InverseAffine());
+			Matrix4x4 shear(
+				1, 2, 3, 4,
+				0, 1, 2, 3,
+				0, 0, 1, 2,
+				0, 0, 0, 1);
+			Assertions::Near(Matrix4x4(
+				1, -2, 1, 0,
+				0, 1, -2, 1,
+				0, 0, 1, -2,
+				0, 0, 0, 1), shear.InverseAffine());
+		}
 		TEST(Matrix4x4Tests, Transpose) {
 			Matrix4x4 example(
 				1, 2, 3, 4,
@@ -238,5 +281,35 @@ namespace TX
 				Assertions::Near(Vec3(3, 3, 2.25), Matrix4x4::TNormal(scaling_inv, Vec3(3, 6, 9)));
 			}
 		}
+
+		TEST(Matrix4x4Tests, Transform_Batch) {
+			Matrix4x4 m = Matrix4x4::Translate(1, 2, 3) * Matrix4x4::Rotate(0.5f, 0.2f, -0.4f) * Matrix4x4::Scale(1, 2, 4);
+			Matrix4x4 m_inv = m.Inverse();
+			std::vector<Vec3> in;
+			for (int i = 0; i < 23; i++)
+				in.push_back(Vec3(float(i), float(i % 5) - 2, 0.5f * i));
+			std::vector<Vec3> points(in.size()), vecs(in.size()), normals(in);
+			Matrix4x4::TPoints(m, in.data(), points.data(), in.size());
+			Matrix4x4::TVecs(m, in.data(), vecs.data(), in.size());
+			Matrix4x4::TNormals(m_inv, normals.data(), normals.data(), normals.size());
+			for (size_t i = 0; i < in.size(); i++){
+				Assertions::Near(Matrix4x4::TPoint(m, in[i]), points[i]);
+				Assertions::Near(Matrix4x4::TVec(m, in[i]), vecs[i]);
+				Assertions::Near(Matrix4x4::TNormal(m_inv, in[i]), normals[i]);
+			}
+			{
+				SCOPED_TRACE("Packet");
+				Vec3 out[4];
+				SSE::StoreVec3x4(Matrix4x4::TPoint(m, SSE::LoadVec3x4(in.data())), out);
+				for (int i = 0; i < 4; i++)
+					Assertions::Near(points[i], out[i]);
+				SSE::StoreVec3x4(Matrix4x4::TVec(m, SSE::LoadVec3x4(in.data())), out);
+				for (int i = 0; i < 4; i++)
+					Assertions::Near(vecs[i], out[i]);
+				SSE::StoreVec3x4(Matrix4x4::TNormal(m_inv, SSE::LoadVec3x4(in.data())), out);
+				for (int i = 0; i < 4; i++)
+					Assertions::Near(normals[i], out[i]);
+			}
+		}
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,195 @@
+#include "txbase_tests/helper.h"
+#include "txbase/sse/packet.h"
+#include "txbase/sse/soa.h"
+
+namespace TX
+{
+	using namespace SSE;
+	namespace Tests
+	{
+		namespace {
+			// written once for every width
+			template<typename P>
+			P Polynomial(const P& x) {
+				return MulAdd(MulAdd(x, P(0.5f), P(-2.f)), x, P(1.f));
+			}
+
+			template<int W>
+			void CheckPacket() {
+				typedef Packet<float, W> F;
+				typedef Packet<bool, W> B;
+				SCOPED_TRACE(::testing::Message() << "width: " << W);
+				EXPECT_EQ(W, int(PacketTraits<F>::WIDTH));
+				EXPECT_TRUE((std::is_same<B, typename PacketTraits<F>::Mask>::value));
+
+				float in[W], out[W];
+				float sum = 0.f;
+				for (int i = 0; i < W; i++)
+					sum += in[i] = float(i - W / 2);
+				const F x = Load<F>(in);
+				const B positive = x >= 0.f;
+				Store(Select(positive, Polynomial(x), Abs(x) * 10.f), out);
+				for (int i = 0; i < W; i++){
+					float expected = in[i] >= 0.f ? (in[i] * 0.5f - 2.f) * in[i] + 1.f : -in[i] * 10.f;
+					EXPECT_EQ(expected, out[i]);
+					EXPECT_EQ(in[i], Lane(x, i));
+				}
+				EXPECT_EQ(sum, ReduceAdd(x));
+				EXPECT_EQ(in[0], ReduceMin(x));
+				EXPECT_EQ(in[W - 1], ReduceMax(x));
+				EXPECT_EQ(W / 2, SelectMin(positive, x));
+				EXPECT_EQ(-1, SelectMin(x > float(W), x));
+				EXPECT_TRUE(Any(positive));
+				EXPECT_EQ(W == 1, All(positive));
+				EXPECT_TRUE(None(x > float(W)));
+
+				// as components of Vec
+				const Vec<3, F> u(x, x * 2.f, F(1.f));
+				const Vec<3, F> v(F(1.f), F(1.f), x);
+				Store(Math::Dot(u, v), out);
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(4.f * in[i], out[i]);
+				const Vec<3, F> c = Math::Cross(u, v);
+				for (int i = 0; i < W; i++)
+					Assertions::Near(Math::Cross(Vec3(in[i], in[i] * 2, 1), Vec3(1, 1, in[i])), Vec3(Lane(c.x, i), Lane(c.y, i), Lane(c.z, i)));
+			}
+
+			template<int W>
+			void CheckIntPacket() {
+				typedef Packet<int32_t, W> I;
+				SCOPED_TRACE(::testing::Message() << "width: " << W);
+				int32_t in[W], out[W];
+				for (int i = 0; i < W; i++)
+					in[i] = i * 3 - 5;
+				const I n = Load<I>(in);
+				Store(Select(n > 0, n * 2, -n), out);
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(in[i] > 0 ? in[i] * 2 : -in[i], out[i]);
+			}
+
+			template<typename P>
+			void CheckMemory() {
+				typedef typename PacketTraits<P>::Scalar T;
+				typedef typename PacketTraits<P>::Index I;
+				const int W = PacketTraits<P>::WIDTH;
+				SCOPED_TRACE(::testing::Message() << "width: " << W);
+				alignas(64) T table[3 * W], out[W];
+				int32_t idx[W];
+				for (int i = 0; i < 3 * W; i++)
+					table[i] = T(i * 2 + 1);
+				for (int i = 0; i < W; i++)
+					idx[i] = (i * 7) % (3 * W);
+
+				const P v = Gather<P>(table, Load<I>(idx));
+				StoreAligned(v, out);
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(table[idx[i]], out[i]);
+				Stream(LoadAligned<P>(table + W), out);
+				StreamFence();
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(table[W + i], out[i]);
+
+				// the tail of an array, lanes off are zero and their memory is left alone
+				for (int n = 0; n <= W; n++){
+					const typename PacketTraits<P>::Mask mask = FirstLanes<P>(n);
+					StoreAligned(MaskedLoad<P>(mask, table), out);
+					for (int i = 0; i < W; i++)
+						EXPECT_EQ(i < n ? table[i] : T(0), out[i]);
+					for (int i = 0; i < W; i++)
+						out[i] = T(-1);
+					MaskedStore(mask, v, out);
+					for (int i = 0; i < W; i++)
+						EXPECT_EQ(i < n ? table[idx[i]] : T(-1), out[i]);
+				}
+			}
+
+			template<int W>
+			void CheckVec3() {
+				typedef Packet<float, W> P;
+				SCOPED_TRACE(::testing::Message() << "width: " << W);
+				std::vector<Vec3> in;
+				for (int i = 0; i < 2 * W + 3; i++)
+					in.emplace_back(float(i), i * 0.5f, -float(i));
+
+				const Vec<3, P> v = LoadVec3<P>(in.data());
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(in[i], Vec3(Lane(v.x, i), Lane(v.y, i), Lane(v.z, i)));
+				std::vector<Vec3> out(W + 1, Vec3(7.f));
+				StoreVec3(v, out.data());
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(in[i], out[i]);
+				EXPECT_EQ(Vec3(7.f), out[W]);
+
+				// packets over the array, the last one partial unless W == 1
+				size_t seen = 0;
+				ForEachPacket<P>(in.data(), in.size(), [&](const Vec<3, P>& p, size_t first, int lanes){
+					EXPECT_EQ(seen, first);
+					for (int i = 0; i < W; i++)
+						EXPECT_EQ(i < lanes ? in[first + i] : Vec3(), Vec3(Lane(p.x, i), Lane(p.y, i), Lane(p.z, i)));
+					seen += lanes;
+				});
+				EXPECT_EQ(in.size(), seen);
+				out = in;
+				ForEachPacket<P>(out.data(), out.data(), out.size(), [](const Vec<3, P>& p){ return p * P(2.f) + Vec<3, P>(P(1.f)); });
+				for (size_t i = 0; i < in.size(); i++)
+					EXPECT_EQ(in[i] * 2.f + Vec3(1.f), out[i]);
+			}
+		}
+
+		TEST(PacketTests, Types) {
+			EXPECT_TRUE((std::is_same<float, Packet<float, 1>>::value));
+			EXPECT_TRUE((std::is_same<V4Float, Packet<float, 4>>::value));
+			EXPECT_TRUE((std::is_same<V4Bool, Packet<bool, 4>>::value));
+			EXPECT_TRUE((std::is_same<PacketArray<float, 3>, Packet<float, 3>>::value));
+			EXPECT_TRUE((std::is_same<Vec3V4F, Vec<3, Packet<float, 4>>>::value));
+			EXPECT_LE(4, PACKET_WIDTH);
+		}
+
+		TEST(PacketTests, Float) {
+			CheckPacket<1>();
+			CheckPacket<3>();
+			CheckPacket<4>();
+			CheckPacket<8>();
+			CheckPacket<16>();
+			CheckPacket<PACKET_WIDTH>();
+		}
+
+		TEST(PacketTests, Int) {
+			CheckIntPacket<1>();
+			CheckIntPacket<4>();
+			CheckIntPacket<8>();
+			CheckIntPacket<16>();
+		}
+
+		TEST(PacketTests, Vec3) {
+			const Vec3 p[4] = { Vec3(0, 1, 2), Vec3(3, 4, 5), Vec3(6, 7, 8), Vec3(9, 10, 11) };
+			V4Float x, y, z, m0, m1, m2;
+			Transpose4x3(V4Float(&p[0].x), V4Float(&p[0].x + 4), V4Float(&p[0].x + 8), x, y, z);
+			Assertions::Equal(V4Float(0, 3, 6, 9), x);
+			Assertions::Equal(V4Float(1, 4, 7, 10), y);
+			Assertions::Equal(V4Float(2, 5, 8, 11), z);
+			Transpose3x4(x, y, z, m0, m1, m2);
+			Assertions::Equal(V4Float(&p[0].x), m0);
+			Assertions::Equal(V4Float(&p[0].x + 4), m1);
+			Assertions::Equal(V4Float(&p[0].x + 8), m2);
+
+			CheckVec3<1>();
+			CheckVec3<3>();
+			CheckVec3<4>();
+			CheckVec3<8>();
+			CheckVec3<16>();
+		}
+
+		TEST(PacketTests, Memory) {
+			CheckMemory<Packet<float, 1>>();
+			CheckMemory<Packet<float, 3>>();
+			CheckMemory<Packet<float, 4>>();
+			CheckMemory<Packet<float, 8>>();
+			CheckMemory<Packet<float, 16>>();
+			CheckMemory<Packet<int32_t, 1>>();
+			CheckMemory<Packet<int32_t, 4>>();
+			CheckMemory<Packet<int32_t, 8>>();
+			CheckMemory<Packet<int32_t, 16>>();
+		}
+	}
+}
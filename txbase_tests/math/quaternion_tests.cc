@@ -1,5 +1,7 @@
 #include "txbase_tests/helper.h"
 #include "txbase/math/quaternion.h"
+#include "txbase/sse/quaternion.h"
+#include <random>
 
 namespace TX
 {
@@ -181,5 +183,83 @@ namespace TX
 				Quaternion(0.279846f, -0.364704f, 0.115916f, 0.880474f),
 				Quaternion::LookRotation(Vec3(0.57735f, 0.57735f, -0.57735f)));
 		}
+
+		namespace {
+			std::vector<Quaternion> RandomRotations(int count, unsigned seed) {
+				std::mt19937 rng(seed);
+				std::uniform_real_distribution<float> uniform(-Math::PI, Math::PI);
+				std::vector<Quaternion> q;
+				for (int i = 0; i < count; i++)
+					q.push_back(Quaternion::Euler(uniform(rng), uniform(rng), uniform(rng)));
+				return q;
+			}
+
+			template<int W>
+			void CheckSlerp(const std::vector<Quaternion>& a, const std::vector<Quaternion>& b) {
+				SCOPED_TRACE(::testing::Message() << "width: " << W);
+				typedef SSE::Packet<float, W> P;
+				for (size_t i = 0; i + W <= a.size(); i += W){
+					float t[W];
+					for (int k = 0; k < W; k++)
+						t[k] = float(i + k) / a.size();
+					const SSE::QuaternionPacket<P> qa = SSE::QuaternionPacket<P>::Load(&a[i]), qb = SSE::QuaternionPacket<P>::Load(&b[i]);
+					Quaternion precise[W], fast[W];
+					SSE::QuaternionPacket<P>::Store(SSE::Slerp(SSE::Load<P>(t), qa, qb), precise);
+					SSE::QuaternionPacket<P>::Store(SSE::SlerpFast(SSE::Load<P>(t), qa, qb), fast);
+					for (int k = 0; k < W; k++){
+						// the packet versions take the shorter arc
+						const Quaternion to = Dot(a[i + k], b[i + k]) < 0 ? -b[i + k] : b[i + k];
+						const Quaternion expected = Slerp(t[k], a[i + k], to);
+						for (int c = 0; c < 4; c++){
+							EXPECT_NEAR(expected.q[c], precise[k].q[c], 1e-5f);
+							EXPECT_NEAR(expected.q[c], fast[k].q[c], 3e-5f);
+						}
+					}
+				}
+			}
+		}
+
+		TEST(QuaternionTests, Packet) {
+			const std::vector<Quaternion> a = RandomRotations(48, 1), b = RandomRotations(48, 2);
+			CheckSlerp<1>(a, b);
+			CheckSlerp<3>(a, b);
+			CheckSlerp<4>(a, b);
+			CheckSlerp<8>(a, b);
+			CheckSlerp<16>(a, b);
+			// no arc at all, where the weights are 1 - t and t
+			CheckSlerp<4>(a, a);
+		}
+
+		TEST(QuaternionTests, Batch) {
+			const int count = 37;
+			const std::vector<Quaternion> a = RandomRotations(count, 3), b = RandomRotations(count, 4);
+			std::vector<Vec3> v;
+			std::vector<float> t;
+			for (int i = 0; i < count; i++){
+				v.push_back(Vec3(float(i), 1.f - i, 0.5f));
+				t.push_back(float(i) / count);
+			}
+			std::vector<Quaternion> product(count), normalized(count), nlerp(count), slerp(count);
+			std::vector<Vec3> rotated(count);
+			std::vector<Matrix3x3> matrices(count);
+			SSE::MultiplyQuaternions(a.data(), b.data(), product.data(), count);
+			SSE::NlerpQuaternions(t.data(), a.data(), b.data(), nlerp.data(), count);
+			SSE::SlerpQuaternions(t.data(), a.data(), b.data(), slerp.data(), count);
+			SSE::RotateVectors(a.data(), v.data(), rotated.data(), count);
+			SSE::RotationMatrices(a.data(), matrices.data(), count);
+			normalized = product;
+			for (auto& q : normalized)
+				q *= 3.f;
+			SSE::NormalizeQuaternions(normalized.data(), normalized.data(), count);
+			for (int i = 0; i < count; i++){
+				const Quaternion to = Dot(a[i], b[i]) < 0 ? -b[i] : b[i];
+				Assertions::Near(a[i] * b[i], product[i]);
+				Assertions::Near(a[i] * b[i], normalized[i]);
+				Assertions::Near(Normalize(a[i] * (1.f - t[i]) + to * t[i]), nlerp[i]);
+				Assertions::Near(Slerp(t[i], a[i], to), slerp[i]);
+				Assertions::Near(a[i].Rotate(v[i]), rotated[i]);
+				Assertions::Near(Matrix3x3(a[i].RotationMatrix4x4()), matrices[i]);
+			}
+		}
 	}
 }
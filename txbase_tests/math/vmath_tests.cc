@@ -0,0 +1,154 @@
+#include "txbase_tests/helper.h"
+#include "txbase/sse/vmath.h"
+#include <random>
+#include <algorithm>
+
+namespace TX
+{
+	using namespace SSE;
+	namespace Tests
+	{
+		namespace {
+			std::vector<float> Uniform(float lo, float hi, int count, unsigned seed) {
+				std::mt19937 rng(seed);
+				std::uniform_real_distribution<float> uniform(lo, hi);
+				std::vector<float> in(count);
+				for (auto& x : in)
+					x = uniform(rng);
+				return in;
+			}
+
+			// f applied W lanes at a time, the last packet padded with copies of the last input
+			template<int W, typename F>
+			std::vector<float> Apply(F f, const std::vector<float>& in) {
+				typedef Packet<float, W> P;
+				std::vector<float> out(in.size());
+				for (size_t i = 0; i < in.size(); i += W){
+					float lanes[W];
+					for (int k = 0; k < W; k++)
+						lanes[k] = in[std::min(i + k, in.size() - 1)];
+					Store(f(Load<P>(lanes)), lanes);
+					for (int k = 0; k < W && i + k < in.size(); k++)
+						out[i + k] = lanes[k];
+				}
+				return out;
+			}
+
+			// error in units of the last place of the correctly rounded result
+			double Ulps(float actual, double expected) {
+				const float rounded = std::abs(float(expected));
+				const double ulp = std::nextafter(std::max(rounded, FLT_MIN), INFINITY) - std::max(rounded, FLT_MIN);
+				return std::abs(actual - expected) / ulp;
+			}
+
+			template<int W, typename F, typename R>
+			void CheckAccuracy(const char *name, F f, R reference, const std::vector<float>& in, double max_ulps, double max_abs) {
+				SCOPED_TRACE(::testing::Message() << name << ", width: " << W);
+				const std::vector<float> out = Apply<W>(f, in);
+				double worst_ulps = 0, worst_abs = 0;
+				for (size_t i = 0; i < in.size(); i++){
+					const double expected = reference(double(in[i]));
+					ASSERT_FALSE(std::isnan(out[i])) << "input " << in[i];
+					worst_ulps = std::max(worst_ulps, Ulps(out[i], expected));
+					worst_abs = std::max(worst_abs, std::abs(out[i] - expected));
+				}
+				if (max_ulps > 0) {
+					EXPECT_GE(max_ulps, worst_ulps);
+				}
+				if (max_abs > 0) {
+					EXPECT_GE(max_abs, worst_abs);
+				}
+			}
+
+			template<int W>
+			void CheckWidth() {
+				typedef Packet<float, W> P;
+				// the whole documented range, and the floats around multiples of pi/2 where the reduction cancels the most
+				std::vector<float> angles = Uniform(-10.f, 10.f, 2000, 1);
+				const std::vector<float> far = Uniform(-8192.f, 8192.f, 2000, 2);
+				angles.insert(angles.end(), far.begin(), far.end());
+				for (int k = -5215; k <= 5215; k += 7){
+					const float x = float(k * 1.57079632679489661923);
+					for (float y : { std::nextafter(x, -INFINITY), x, std::nextafter(x, INFINITY) })
+						angles.push_back(y);
+				}
+				for (float x : { 0.f, -0.f, float(Math::PI), Math::PI * 0.5f, -Math::PI * 0.25f, 1e-5f })
+					angles.push_back(x);
+				CheckAccuracy<W>("sin", [](const P& x){ P s, c; VMath::SinCos(x, &s, &c); return s; }, [](double x){ return std::sin(x); }, angles, 1, 0);
+				CheckAccuracy<W>("cos", [](const P& x){ P s, c; VMath::SinCos(x, &s, &c); return c; }, [](double x){ return std::cos(x); }, angles, 1, 0);
+				CheckAccuracy<W>("sin", [](const P& x){ return VMath::Sin(x); }, [](double x){ return std::sin(x); }, angles, 1, 0);
+				CheckAccuracy<W>("cos", [](const P& x){ return VMath::Cos(x); }, [](double x){ return std::cos(x); }, angles, 1, 0);
+				CheckAccuracy<W>("sin fast", [](const P& x){ P s, c; VMath::SinCosFast(x, &s, &c); return s; }, [](double x){ return std::sin(x); }, angles, 0, 2e-6);
+				CheckAccuracy<W>("cos fast", [](const P& x){ P s, c; VMath::SinCosFast(x, &s, &c); return c; }, [](double x){ return std::cos(x); }, angles, 0, 2e-6);
+
+				std::vector<float> tangents = Uniform(-3.f, 3.f, 2000, 4);
+				for (float x : { 0.f, 1.f, -1e4f, 1e30f, INFINITY, -INFINITY })
+					tangents.push_back(x);
+				CheckAccuracy<W>("atan", [](const P& x){ return VMath::Atan(x); }, [](double x){ return std::atan(x); }, tangents, 2, 0);
+				CheckAccuracy<W>("atan fast", [](const P& x){ return VMath::AtanFast(x); }, [](double x){ return std::atan(x); }, tangents, 0, 2e-5);
+
+				// atan2 along the directions of the unit circle and at the axes
+				std::vector<float> directions = Uniform(-Math::PI, Math::PI, 2000, 5);
+				for (float x : { 0.f, Math::PI * 0.5f, float(Math::PI), -Math::PI * 0.5f })
+					directions.push_back(x);
+				const auto atan2 = [](double t){ return std::atan2(double(std::sin(float(t)) * 3.f), double(std::cos(float(t)) * 3.f)); };
+				CheckAccuracy<W>("atan2", [](const P& t){ return VMath::Atan2(VMath::Sin(t) * P(3.f), VMath::Cos(t) * P(3.f)); }, atan2, directions, 4, 0);
+				CheckAccuracy<W>("atan2 fast", [](const P& t){ return VMath::Atan2Fast(VMath::Sin(t) * P(3.f), VMath::Cos(t) * P(3.f)); }, atan2, directions, 0, 2e-5);
+
+				// both coordinates infinite, along the diagonals
+				const float diagonals[4][3] = {
+					{ INFINITY, INFINITY, 0.25f }, { INFINITY, -INFINITY, 0.75f },
+					{ -INFINITY, INFINITY, -0.25f }, { -INFINITY, -INFINITY, -0.75f } };
+				for (auto& d : diagonals){
+					float y[W], x[W], out[W], fast[W];
+					std::fill(y, y + W, d[0]);
+					std::fill(x, x + W, d[1]);
+					Store(VMath::Atan2(Load<P>(y), Load<P>(x)), out);
+					Store(VMath::Atan2Fast(Load<P>(y), Load<P>(x)), fast);
+					for (int k = 0; k < W; k++){
+						EXPECT_FLOAT_EQ(d[2] * Math::PI, out[k]) << "atan2(" << d[0] << ", " << d[1] << ")";
+						EXPECT_NEAR(d[2] * Math::PI, fast[k], 2e-5) << "atan2 fast(" << d[0] << ", " << d[1] << ")";
+					}
+				}
+
+				std::vector<float> cosines = Uniform(-1.f, 1.f, 2000, 6);
+				for (float x : { -1.f, -0.5f, 0.f, 0.5f, 1.f })
+					cosines.push_back(x);
+				CheckAccuracy<W>("asin", [](const P& x){ return VMath::Asin(x); }, [](double x){ return std::asin(x); }, cosines, 2, 0);
+				CheckAccuracy<W>("acos", [](const P& x){ return VMath::Acos(x); }, [](double x){ return std::acos(x); }, cosines, 2, 0);
+				CheckAccuracy<W>("asin fast", [](const P& x){ return VMath::AsinFast(x); }, [](double x){ return std::asin(x); }, cosines, 0, 1e-4);
+				CheckAccuracy<W>("acos fast", [](const P& x){ return VMath::AcosFast(x); }, [](double x){ return std::acos(x); }, cosines, 0, 1e-4);
+
+				const std::vector<float> positive = Uniform(1e-3f, 1e3f, 2000, 7);
+				CheckAccuracy<W>("sqrt", [](const P& x){ return Sqrt(x); }, [](double x){ return std::sqrt(x); }, positive, 0.5, 0);
+				CheckAccuracy<W>("rsqrt", [](const P& x){ return Rsqrt(x); }, [](double x){ return 1 / std::sqrt(x); }, positive, 1.5, 0);
+				CheckAccuracy<W>("rcp", [](const P& x){ return Rcp(x); }, [](double x){ return 1 / x; }, positive, 0.5, 0);
+				CheckAccuracy<W>("sqrt fast", [](const P& x){ return SqrtFast(x); }, [](double x){ return std::sqrt(x); }, positive, 4, 0);
+				CheckAccuracy<W>("rsqrt fast", [](const P& x){ return RsqrtFast(x); }, [](double x){ return 1 / std::sqrt(x); }, positive, 4, 0);
+				CheckAccuracy<W>("rcp fast", [](const P& x){ return RcpFast(x); }, [](double x){ return 1 / x; }, positive, 4, 0);
+				float zero[W] = {};
+				Store(SqrtFast(Load<P>(zero)), zero);
+				for (int i = 0; i < W; i++)
+					EXPECT_EQ(0.f, zero[i]);
+			}
+		}
+
+		TEST(VMathTests, Accuracy) {
+			CheckWidth<1>();
+			CheckWidth<3>();
+			CheckWidth<4>();
+			CheckWidth<8>();
+			CheckWidth<16>();
+		}
+
+		TEST(VMathTests, Division) {
+			const std::vector<float> a = Uniform(-100.f, 100.f, 64, 8), b = Uniform(0.1f, 100.f, 64, 9);
+			for (size_t i = 0; i < a.size(); i += 4){
+				float out[4];
+				Store(V4Float(&a[i]) / V4Float(&b[i]), out);
+				for (int k = 0; k < 4; k++)
+					EXPECT_EQ(a[i + k] / b[i + k], out[k]);
+			}
+		}
+	}
+}
@@ -0,0 +1,244 @@
+#include "txbase_tests/helper.h"
+#include "txbase/sys/memory.h"
+#include "txbase/sys/arenapool.h"
+#include "txbase/sys/parallel.h"
+#include "txbase/image/image.h"
+#include <sstream>
+#include <numeric>
+
+namespace TX
+{
+	namespace Tests
+	{
+		TEST(MemoryArenaTests, Stats) {
+			MemoryArena arena(1024);
+			EXPECT_EQ(0u, arena.BytesUsed());
+			EXPECT_EQ(1024u, arena.BytesReserved());
+			arena.Alloc<char>(10);
+			arena.Alloc<float>(4);
+			EXPECT_EQ(32u, arena.BytesUsed());
+			arena.Alloc<char>(2000);
+			EXPECT_EQ(1024u + 2000u, arena.BytesReserved());
+			arena.FreeAll();
+			EXPECT_EQ(0u, arena.BytesUsed());
+			EXPECT_EQ(32u + 2000u, arena.PeakBytesUsed());
+		}
+
+		TEST(MemoryArenaTests, Rewind) {
+			MemoryArena arena(256);
+			int *outer = arena.Alloc<int>(8);
+			for (int i = 0; i < 8; i++)
+				outer[i] = i;
+			MemoryArena::Marker mark = arena.Mark();
+			size_t reserved;
+			{
+				ArenaScope scope(arena);
+				// spills over several blocks, and a block of its own
+				for (int i = 0; i < 20; i++)
+					MemClear(arena.Alloc<char>(100), 100);
+				arena.Alloc<char>(1000);
+				reserved = arena.BytesReserved();
+			}
+			EXPECT_EQ(mark.bytesUsed, arena.BytesUsed());
+			// the large block is gone, the regular ones are kept for reuse
+			EXPECT_EQ(reserved - 1008, arena.BytesReserved());
+			EXPECT_EQ((char *)(outer + 8), arena.Alloc<char>(16));
+			for (int i = 0; i < 8; i++)
+				EXPECT_EQ(i, outer[i]);
+			arena.FreeAll();
+			arena.Trim();
+			EXPECT_EQ(256u, arena.BytesReserved());
+		}
+
+		TEST(MemoryArenaTests, Alignment) {
+			struct alignas(64) Line { float values[16]; };
+			struct alignas(128) Wide { char bytes[8]; };
+			MemoryArena arena(512);
+			for (int i = 0; i < 20; i++){
+				EXPECT_EQ(0u, uintptr_t(arena.Alloc<char>(3)) % 16);
+				EXPECT_EQ(0u, uintptr_t(arena.Alloc<Line>()) % 64);
+				EXPECT_EQ(0u, uintptr_t(arena.Alloc<Wide>(2)) % 128);
+			}
+			EXPECT_EQ(0u, uintptr_t(arena.Alloc(600, 256)) % 256);
+		}
+
+		TEST(MemoryArenaTests, Allocator) {
+			MemoryArena arena(4096);
+			ArenaVector<double> values(&arena);
+			for (int i = 0; i < 100; i++)
+				values.push_back(i);
+			EXPECT_EQ(4950.0, std::accumulate(values.begin(), values.end(), 0.0));
+			EXPECT_EQ(0u, uintptr_t(values.data()) % alignof(double));
+			EXPECT_GE(arena.BytesUsed(), 100u * sizeof(double));
+
+			// rebound allocators share the arena
+			ArenaAllocator<char> chars(values.get_allocator());
+			EXPECT_EQ(&arena, chars.Arena());
+			EXPECT_TRUE(chars == values.get_allocator());
+
+			ResetArenaVector(values, nullptr);
+			EXPECT_TRUE(values.empty());
+			arena.FreeAll();
+			for (int i = 0; i < 100; i++)
+				values.push_back(i);
+			EXPECT_EQ(0u, arena.BytesUsed());
+			EXPECT_EQ(nullptr, values.get_allocator().Arena());
+		}
+
+		TEST(ArenaPoolTests, PerWorker) {
+			TaskScheduler *scheduler = TaskScheduler::Instance();
+			TaskScheduler::Config config;
+			config.worker_count = 4;
+			scheduler->StartAll(config);
+			{
+				ArenaPool pool;
+				ASSERT_EQ(5, pool.Size());
+				for (int frame = 0; frame < 3; frame++){
+					TaskGroup group;
+					for (int i = 0; i < 100; i++){
+						group.Run([&pool](int id) {
+							int *values = pool[id].Alloc<int>(16);
+							for (int j = 0; j < 16; j++)
+								values[j] = id;
+						});
+					}
+					ParallelFor(0, 100, 1, [&pool](int /*i*/) { pool.Local().Alloc<int>(16); });
+					group.Wait();
+					EXPECT_EQ(200u * 64u, pool.TotalBytesUsed());
+					size_t sum = 0;
+					for (int id = 0; id < pool.Size(); id++)
+						sum += pool.BytesUsed(id);
+					EXPECT_EQ(pool.TotalBytesUsed(), sum);
+					pool.FreeAll();
+					EXPECT_EQ(0u, pool.TotalBytesUsed());
+				}
+			}
+			TaskScheduler::DeleteInstance();
+		}
+
+		TEST(ObjectPoolTests, Reuse) {
+			struct Node {
+				Node(int value, int *live) : value(value), live(live) { (*live)++; }
+				~Node() { (*live)--; }
+				int value;
+				int *live;
+			};
+			int live = 0;
+			ObjectPool<Node> pool(16);
+			std::vector<Node *> nodes;
+			for (int i = 0; i < 40; i++)
+				nodes.push_back(pool.New(i, &live));
+			EXPECT_EQ(40, live);
+			EXPECT_EQ(40u, pool.Count());
+			EXPECT_EQ(48u, pool.Capacity());
+			for (int i = 0; i < 40; i++){
+				EXPECT_EQ(i, nodes[i]->value);
+				EXPECT_EQ(0u, uintptr_t(nodes[i]) % alignof(Node));
+			}
+			Node *last = nodes.back();
+			for (Node *node : nodes)
+				pool.Delete(node);
+			EXPECT_EQ(0, live);
+			EXPECT_EQ(0u, pool.Count());
+			EXPECT_EQ(last, pool.New(0, &live));		// the last freed comes back first
+			EXPECT_EQ(48u, pool.Capacity());
+		}
+
+		TEST(ObjectPoolTests, CrossThread) {
+			struct alignas(32) Payload {
+				int values[20];
+			};
+			ObjectPool<Payload, true> pool;
+			std::vector<Payload *> payloads(1000);
+			for (auto& payload : payloads){
+				payload = pool.New();
+				EXPECT_EQ(0u, uintptr_t(payload) % 64);
+				payload->values[0] = 1;
+			}
+			std::thread other([&]() {
+				for (auto payload : payloads)
+					pool.Delete(payload);
+			});
+			other.join();
+			for (auto& payload : payloads)
+				payload = pool.New();
+			for (auto payload : payloads)
+				pool.Delete(payload);
+		}
+
+		TEST(MemoryTrackerTests, Tags) {
+			MemoryTagStats before = MemoryTracker::Stats(MemoryTag::Film);
+			float *buffer = AllocAligned<float>(1000, 64, MemoryTag::Film);
+			ASSERT_NE(nullptr, buffer);
+			EXPECT_EQ(0u, uintptr_t(buffer) % 64);
+			buffer[999] = 1.f;
+			MemoryTagStats allocated = MemoryTracker::Stats(MemoryTag::Film);
+			FreeAligned(buffer);
+			EXPECT_EQ(nullptr, buffer);
+			MemoryTagStats freed = MemoryTracker::Stats(MemoryTag::Film);
+			if (MemoryTracker::ENABLED){
+				EXPECT_EQ(before.current + 4000u, allocated.current);
+				EXPECT_GE(allocated.peak, allocated.current);
+				EXPECT_EQ(before.allocations + 1, allocated.allocations);
+				EXPECT_EQ(before.current, freed.current);
+			}
+			else {
+				EXPECT_EQ(0u, allocated.current);
+				EXPECT_EQ(0u, allocated.allocations);
+			}
+
+			size_t imageBytes = MemoryTracker::Stats(MemoryTag::Image).current;
+			{
+				Image image(64, 32);
+				if (MemoryTracker::ENABLED) {
+					EXPECT_EQ(imageBytes + 64u * 32u * sizeof(Color), MemoryTracker::Stats(MemoryTag::Image).current);
+				}
+			}
+			EXPECT_EQ(imageBytes, MemoryTracker::Stats(MemoryTag::Image).current);
+
+			std::stringstream dump;
+			MemoryTracker::Dump(dump);
+			if (MemoryTracker::ENABLED) {
+				EXPECT_NE(std::string::npos, dump.str().find("film"));
+			}
+		}
+
+		TEST(MemoryTests, LargeAllocations) {
+			const size_t size = size_t(5) << 20;
+			PageAllocStats before = GetPageAllocStats();
+			char *buffer = AllocAligned<char>(uint32_t(size), 64, MemoryTag::Image);
+			ASSERT_NE(nullptr, buffer);
+			buffer[0] = buffer[size - 1] = 1;
+			PageAllocStats mapped = GetPageAllocStats();
+#if defined(__linux__) || defined(_WIN32)
+			EXPECT_EQ(before.allocations + 1, mapped.allocations);
+			EXPECT_GE(mapped.bytes - before.bytes, size);
+			EXPECT_EQ(0u, uintptr_t(buffer) % PAGE_ALLOC_ALIGNMENT);
+			if (MemoryTracker::ENABLED) {
+				EXPECT_LE(size, MemoryTracker::Stats(MemoryTag::Image).current);
+			}
+#endif
+			FreeAligned(buffer);
+			EXPECT_EQ(before.allocations, GetPageAllocStats().allocations);
+
+			// below the threshold, and with huge pages disabled
+			buffer = AllocAligned<char>(4096);
+			EXPECT_EQ(before.allocations, GetPageAllocStats().allocations);
+			FreeAligned(buffer);
+			size_t threshold = LargeAllocThreshold();
+			SetLargeAllocThreshold(SIZE_MAX);
+			buffer = AllocAligned<char>(uint32_t(size));
+			EXPECT_EQ(before.allocations, GetPageAllocStats().allocations);
+			FreeAligned(buffer);
+			SetLargeAllocThreshold(threshold);
+
+			// arena blocks of large allocations go the same way
+			MemoryArena arena;
+			arena.Alloc<char>(size);
+			EXPECT_EQ(mapped.allocations, GetPageAllocStats().allocations);
+			arena.FreeAll();
+			EXPECT_EQ(before.allocations, GetPageAllocStats().allocations);
+			EXPECT_FALSE(FreePages(&arena));
+		}
+	}
+}
@@ -0,0 +1,529 @@
+#include "txbase_tests/helper.h"
+#include "txbase/sys/thread.h"
+#include "txbase/sys/parallel.h"
+#include "txbase/sys/taskgraph.h"
+#include "txbase/sys/future.h"
+
+#include <algorithm>
+
+namespace TX
+{
+	namespace Tests
+	{
+		class TaskSchedulerTests : public ::testing::Test {
+		protected:
+			void SetUp() override {
+				scheduler = TaskScheduler::Instance();
+				// more workers than processors is fine, and exercises stealing on small machines
+				TaskScheduler::Config config;
+				config.worker_count = 4;
+				scheduler->StartAll(config);
+			}
+			void TearDown() override {
+				TaskScheduler::DeleteInstance();
+			}
+			TaskScheduler *scheduler;
+		};
+
+		static void Increment(void *args, int /*id*/){
+			(*(std::atomic_int *)args)++;
+		}
+
+		static void Spawn(void *args, int id){
+			TaskScheduler::Task task(Increment, args);
+			for (int i = 0; i < 8; i++)
+				TaskScheduler::Instance()->AddTask(task);
+			Increment(args, id);
+		}
+
+		struct TreeArgs {
+			TaskGroup *group;
+			std::atomic_int *counter;
+			std::vector<TreeArgs> *nodes;
+			int index;
+		};
+
+		// spawns the children of a binary tree from inside the running task
+		static void VisitTree(void *args, int /*id*/){
+			TreeArgs *node = (TreeArgs *)args;
+			(*node->counter)++;
+			for (int child = node->index * 2 + 1; child <= node->index * 2 + 2; child++){
+				if (child < int(node->nodes->size()))
+					node->group->Run(VisitTree, &(*node->nodes)[child]);
+			}
+		}
+
+		static void Block(void *args, int /*id*/){
+			std::atomic_int *state = (std::atomic_int *)args;
+			*state = 1;
+			while (*state != 2)
+				std::this_thread::yield();
+		}
+
+		struct StageArgs {
+			std::atomic_int *clock;
+			int finished_at;
+		};
+
+		static void Stage(void *args, int /*id*/){
+			StageArgs *stage = (StageArgs *)args;
+			stage->finished_at = ++(*stage->clock);
+		}
+
+		TEST(TaskTests, Closure) {
+			int value = 0;
+			TaskScheduler::Task task([&value](int id) { value += id; });
+			task.Run(3);
+			TaskScheduler::Task copy(task);
+			copy.Run(4);
+			EXPECT_EQ(7, value);
+
+			// larger than the inline buffer
+			double payload[16] = { 1 };
+			TaskScheduler::Task large([payload, &value]() { value += int(payload[0]); });
+			TaskScheduler::Task moved(std::move(large));
+			EXPECT_TRUE(large.Empty());
+			moved.Run(0);
+			copy = moved;
+			copy.Run(0);
+			EXPECT_EQ(9, value);
+
+			// move-only callable
+			std::unique_ptr<int> owned(new int(5));
+			TaskScheduler::Task unique([owned = std::move(owned), &value]() { value += *owned; });
+			unique.Run(0);
+			EXPECT_EQ(14, value);
+		}
+
+		TEST(TaskDequeTests, PushPop) {
+			TaskDeque<int> deque(2);
+			int items[5] = { 0, 1, 2, 3, 4 };
+			for (int i = 0; i < 5; i++)
+				deque.Push(&items[i]);
+			EXPECT_EQ(5, deque.Size());
+			EXPECT_EQ(&items[0], deque.Steal());
+			EXPECT_EQ(&items[4], deque.Pop());
+			EXPECT_EQ(&items[3], deque.Pop());
+			EXPECT_EQ(&items[1], deque.Steal());
+			EXPECT_EQ(&items[2], deque.Pop());
+			EXPECT_EQ(nullptr, deque.Pop());
+			EXPECT_EQ(nullptr, deque.Steal());
+			EXPECT_TRUE(deque.Empty());
+		}
+
+		TEST(CpuTopologyTests, Placement) {
+			const CpuTopology& topology = CpuTopology::Get();
+			ASSERT_GE(topology.ProcessorCount(), 1);
+			ASSERT_GE(topology.NodeCount(), 1);
+			for (int i = 0; i < topology.ProcessorCount(); i++){
+				EXPECT_LT(topology[i].node, topology.NodeCount());
+				EXPECT_EQ(&topology[i], topology.Find(topology[i].cpu));
+			}
+			for (bool interleave : { false, true }){
+				std::vector<int> order = topology.PlacementOrder(interleave);
+				ASSERT_EQ(topology.ProcessorCount(), int(order.size()));
+				std::sort(order.begin(), order.end());
+				EXPECT_TRUE(std::unique(order.begin(), order.end()) == order.end());
+			}
+			// the first SMT thread of every core comes before the siblings
+			std::vector<int> node = topology.NodeProcessors(0);
+			for (size_t i = 1; i < node.size(); i++)
+				EXPECT_LE(topology.Find(node[i - 1])->thread, topology.Find(node[i])->thread);
+		}
+
+		TEST_F(TaskSchedulerTests, Config) {
+			const CpuTopology& topology = CpuTopology::Get();
+			EXPECT_EQ(4, scheduler->ThreadCount());
+			scheduler->StopAll();
+			TaskScheduler::Config config;
+			config.worker_count = 3;
+			config.pin_workers = true;
+			config.numa_aware = true;
+			scheduler->StartAll(config);
+			ASSERT_EQ(3, scheduler->ThreadCount());
+			for (int i = 0; i < 3; i++){
+				const TaskScheduler::Worker& worker = scheduler->GetWorker(i);
+				ASSERT_NE(-1, worker.Cpu());
+				EXPECT_EQ(topology.Find(worker.Cpu())->node, worker.Node());
+#ifdef __linux__
+				EXPECT_TRUE(worker.Pinned());
+#endif
+			}
+			std::atomic_int counter(0);
+			ParallelFor(0, 1000, 1, [&](int) { counter++; });
+			EXPECT_EQ(1000, counter);
+
+			// restarting keeps the configuration
+			scheduler->StopAll();
+			scheduler->StartAll();
+			EXPECT_EQ(3, scheduler->ThreadCount());
+			EXPECT_TRUE(scheduler->GetConfig().pin_workers);
+
+			// restricted to one processor
+			scheduler->StopAll();
+			config = TaskScheduler::Config();
+			config.cpus.push_back(topology[0].cpu);
+			scheduler->StartAll(config);
+			EXPECT_EQ(1, scheduler->ThreadCount());
+			EXPECT_EQ(topology[0].cpu, scheduler->GetWorker(0).Cpu());
+		}
+
+		TEST_F(TaskSchedulerTests, JoinAll) {
+			std::atomic_int counter(0);
+			TaskScheduler::Task task(Increment, &counter);
+			for (int i = 0; i < 1000; i++)
+				scheduler->AddTask(task);
+			scheduler->JoinAll();
+			EXPECT_EQ(1000, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, AddTaskFromWorker) {
+			std::atomic_int counter(0);
+			TaskScheduler::Task task(Spawn, &counter);
+			for (int i = 0; i < 100; i++)
+				scheduler->AddTask(task);
+			scheduler->JoinAll();
+			EXPECT_EQ(900, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, Restart) {
+			std::atomic_int counter(0);
+			TaskScheduler::Task task(Increment, &counter);
+			scheduler->StopAll();
+			for (int i = 0; i < 10; i++)
+				scheduler->AddTask(task);
+			scheduler->StartAll();
+			scheduler->JoinAll();
+			EXPECT_EQ(10, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, AddTasks) {
+			std::atomic_int counter(0);
+			std::vector<TaskScheduler::Task> tasks(100, TaskScheduler::Task(Increment, &counter));
+			scheduler->AddTasks(tasks);
+			scheduler->JoinAll();
+			EXPECT_EQ(100, counter);
+
+			// bulk submission from the workers, parking as soon as they are idle
+			scheduler->StopAll();
+			TaskScheduler::Config config = scheduler->GetConfig();
+			config.spin_count = 0;
+			config.yield_count = 0;
+			scheduler->StartAll(config);
+			TaskGroup group;
+			for (int i = 0; i < 10; i++){
+				group.Run([&group, &tasks]() { group.Run(tasks.data(), tasks.size()); });
+				group.Wait();
+			}
+			EXPECT_EQ(1100, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, Priority) {
+			typedef TaskScheduler::Priority Priority;
+			std::atomic_int inherited(0);
+			TaskGroup background(Priority::Background);
+			background.Run([&]() {
+				EXPECT_EQ(Priority::Background, scheduler->CurrentPriority());
+				// tasks added by a background task are background tasks too, unless asked otherwise
+				TaskGroup children;
+				children.Run([&]() { if (scheduler->CurrentPriority() == Priority::Background) inherited++; });
+				children.Run(TaskScheduler::Task([&]() { inherited += 10; }));
+				children.Wait();
+			});
+			background.Wait();
+			EXPECT_EQ(11, inherited);
+			EXPECT_EQ(Priority::Interactive, scheduler->CurrentPriority());
+
+			// background work never occupies more workers than allowed, and interactive work still gets through
+			scheduler->StopAll();
+			TaskScheduler::Config config = scheduler->GetConfig();
+			config.background_workers = 1;
+			scheduler->StartAll(config);
+			std::atomic_int running(0), most(0), interactive(0);
+			std::atomic_int state(0);
+			for (int i = 0; i < 20; i++){
+				background.Run([&]() {
+					int now = ++running;
+					int seen = most;
+					while (now > seen && !most.compare_exchange_weak(seen, now));
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+					running--;
+				});
+			}
+			TaskGroup frame;
+			for (int i = 0; i < 100; i++)
+				frame.Run(Increment, &interactive);
+			frame.Wait();
+			EXPECT_EQ(100, interactive);
+			background.Wait();
+			EXPECT_EQ(1, most);
+		}
+
+		TEST_F(TaskSchedulerTests, PriorityStarvation) {
+			// a single worker flooded with interactive tasks still gets to the background one
+			scheduler->StopAll();
+			TaskScheduler::Config config;
+			config.worker_count = 1;
+			config.starvation_limit = 4;
+			scheduler->StartAll(config);
+			std::atomic_bool done(false);
+			std::atomic_int interactive(0);
+			TaskGroup group;
+			std::function<void()> flood = [&]() {
+				interactive++;
+				if (!done)
+					group.Run(flood);
+			};
+			group.Run(flood);
+			scheduler->AddTask([&]() { done = true; }, TaskScheduler::Priority::Background);
+			group.Wait();
+			scheduler->JoinAll();
+			EXPECT_TRUE(done);
+			EXPECT_GT(interactive, 0);
+		}
+
+		TEST_F(TaskSchedulerTests, ParallelFor) {
+			std::vector<int> values(10000, 0);
+			ParallelFor(0, int(values.size()), 16, [&](int i) { values[i] += i; });
+			for (int i = 0; i < int(values.size()); i++)
+				ASSERT_EQ(i, values[i]);
+			ParallelFor(0, int(values.size()), 0, [&](int i) { values[i] -= i; });
+			EXPECT_EQ(values.size(), size_t(std::count(values.begin(), values.end(), 0)));
+		}
+
+		TEST_F(TaskSchedulerTests, ParallelForNested) {
+			std::atomic_int counter(0);
+			ParallelFor(0, 64, 1, [&](int) {
+				ParallelFor(0, 64, 4, [&](int) { counter++; });
+			});
+			EXPECT_EQ(64 * 64, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, ParallelReduce) {
+			int64_t sum = ParallelReduce(0, 100000, 64, int64_t(0),
+				[](int i) { return int64_t(i); },
+				[](int64_t a, int64_t b) { return a + b; });
+			EXPECT_EQ(int64_t(99999) * 100000 / 2, sum);
+			// combined in order, so non-commutative reductions work as well
+			std::string str = ParallelReduce(0, 26, 1, std::string(),
+				[](int i) { return std::string(1, char('a' + i)); },
+				[](const std::string& a, const std::string& b) { return a + b; });
+			EXPECT_EQ("abcdefghijklmnopqrstuvwxyz", str);
+			EXPECT_EQ(7, ParallelReduce(5, 5, 0, 7, [](int i) { return i; }, [](int a, int b) { return a + b; }));
+		}
+
+		TEST_F(TaskSchedulerTests, TaskGroup) {
+			std::atomic_int state(0), counter(0);
+			TaskScheduler::Task block(Block, &state);
+			scheduler->AddTask(block);
+			while (state != 1)
+				std::this_thread::yield();
+			{
+				// the group doesn't wait for the blocked task, and the waiting thread runs the tasks itself
+				// when all the workers are busy
+				TaskGroup group;
+				for (int i = 0; i < 100; i++)
+					group.Run(Increment, &counter);
+				group.Wait();
+				EXPECT_EQ(100, counter);
+				EXPECT_EQ(0, group.Count());
+				group.Run(Increment, &counter);
+			}
+			EXPECT_EQ(101, counter);
+			state = 2;
+			scheduler->JoinAll();
+		}
+
+		TEST_F(TaskSchedulerTests, TaskGroupSpawn) {
+			std::atomic_int counter(0);
+			TaskGroup group;
+			std::vector<TreeArgs> nodes(1000);
+			for (int i = 0; i < int(nodes.size()); i++)
+				nodes[i] = { &group, &counter, &nodes, i };
+			group.Run(VisitTree, &nodes[0]);
+			group.Wait();
+			EXPECT_EQ(1000, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, TaskGraph) {
+			// a -> (b, c) -> d, e is independent
+			std::atomic_int clock(0);
+			StageArgs stages[5];
+			TaskGraph graph;
+			TaskGraph::Node nodes[5];
+			for (int i = 0; i < 5; i++){
+				stages[i].clock = &clock;
+				nodes[i] = graph.AddNode(Stage, &stages[i]);
+			}
+			graph.Precede(nodes[0], nodes[1]);
+			graph.Precede(nodes[0], nodes[2]);
+			graph.Precede(nodes[1], nodes[3]);
+			graph.Precede(nodes[2], nodes[3]);
+			for (int run = 0; run < 3; run++){
+				clock = 0;
+				for (auto& stage : stages)
+					stage.finished_at = 0;
+				graph.Execute();
+				EXPECT_EQ(5, clock);
+				EXPECT_LT(stages[0].finished_at, stages[1].finished_at);
+				EXPECT_LT(stages[0].finished_at, stages[2].finished_at);
+				EXPECT_LT(stages[1].finished_at, stages[3].finished_at);
+				EXPECT_LT(stages[2].finished_at, stages[3].finished_at);
+				EXPECT_GT(stages[4].finished_at, 0);
+			}
+		}
+
+		TEST_F(TaskSchedulerTests, TaskGraphCycle) {
+			TaskGraph graph;
+			TaskGraph::Node a = graph.AddNode(Increment, nullptr);
+			TaskGraph::Node b = graph.AddNode(Increment, nullptr);
+			graph.Precede(a, b);
+			graph.Precede(b, a);
+			EXPECT_THROW(graph.Run(), std::runtime_error);
+		}
+
+		TEST_F(TaskSchedulerTests, AddClosure) {
+			std::atomic_int counter(0);
+			std::vector<int> big(100, 1);
+			TaskGroup group;
+			for (int i = 0; i < 1000; i++){
+				if (i % 2)
+					group.Run([&counter, i](int /*id*/) { counter += i; });
+				else
+					group.Run([&counter, big, i]() { counter += big[i % 100] * i; });
+			}
+			group.Wait();
+			EXPECT_EQ(999 * 1000 / 2, counter);
+			scheduler->AddTask([&counter]() { counter = -1; });
+			scheduler->JoinAll();
+			EXPECT_EQ(-1, counter);
+		}
+
+		TEST_F(TaskSchedulerTests, Future) {
+			Future<int> parsed = Async([]() { return 20; });
+			Future<std::string> chained = parsed
+				.Then([](int value) { return value + 1; })
+				.Then([](int value) { return std::to_string(value * 2); });
+			EXPECT_EQ("42", chained.Get());
+			EXPECT_EQ(20, parsed.Get());
+
+			// exceptions skip the continuations
+			std::atomic_int called(0);
+			Future<void> failed = Async([]() -> int { throw std::runtime_error("decode"); })
+				.Then([&](int) { called++; });
+			EXPECT_THROW(failed.Get(), std::runtime_error);
+			EXPECT_EQ(0, called);
+
+			// fulfilled by hand, the continuation is queued rather than run by the fulfilling thread
+			Promise<int> promise;
+			Future<int> next = promise.GetFuture().Then([](int value) { return value * 3; });
+			EXPECT_FALSE(next.Ready());
+			scheduler->StopAll();
+			promise.SetValue(5);
+			EXPECT_FALSE(next.Ready());
+			scheduler->StartAll();
+			EXPECT_EQ(15, next.Get());
+		}
+
+		TEST_F(TaskSchedulerTests, BrokenPromise) {
+			Future<int> orphan, next;
+			{
+				Promise<int> promise;
+				orphan = promise.GetFuture();
+				next = orphan.Then([](int value) { return value + 1; });
+				{
+					Promise<int> copy = promise;
+				}
+				EXPECT_FALSE(orphan.Ready());
+			}
+			EXPECT_TRUE(orphan.Ready());
+			try {
+				orphan.Get();
+				FAIL() << "a broken promise should throw";
+			}
+			catch (const std::future_error& e) {
+				EXPECT_EQ(std::make_error_code(std::future_errc::broken_promise), e.code());
+			}
+			EXPECT_THROW(next.Get(), std::future_error);
+
+			// a fulfilled promise leaves its value behind
+			Future<int> kept;
+			{
+				Promise<int> promise;
+				kept = promise.GetFuture();
+				promise.SetValue(3);
+			}
+			EXPECT_EQ(3, kept.Get());
+		}
+
+		TEST_F(TaskSchedulerTests, WhenAll) {
+			std::vector<Future<int>> squares;
+			for (int i = 0; i < 50; i++)
+				squares.push_back(Async([i]() { return i * i; }));
+			std::vector<int> values = WhenAll(squares).Get();
+			ASSERT_EQ(50u, values.size());
+			for (int i = 0; i < 50; i++)
+				EXPECT_EQ(i * i, values[i]);
+
+			std::atomic_int counter(0);
+			std::vector<Future<void>> steps;
+			for (int i = 0; i < 10; i++)
+				steps.push_back(Async([&counter]() { counter++; }));
+			WhenAll(steps).Then([&counter]() { counter += 100; }).Wait();
+			EXPECT_EQ(110, counter);
+			EXPECT_TRUE(WhenAll(std::vector<Future<void>>()).Ready());
+
+			std::vector<Future<int>> partial = { Async([]() -> int { throw std::logic_error("first"); }), Async([]() { return 1; }) };
+			EXPECT_THROW(WhenAll(partial).Get(), std::logic_error);
+		}
+
+		TEST_F(TaskSchedulerTests, WhenAny) {
+			Promise<int> never;
+			std::vector<Future<int>> futures = { never.GetFuture(), Async([]() { return 7; }) };
+			size_t first = WhenAny(futures).Get();
+			EXPECT_EQ(1u, first);
+			EXPECT_EQ(7, futures[first].Get());
+			never.SetValue(0);
+		}
+
+		TEST_F(TaskSchedulerTests, Telemetry) {
+			scheduler->StopAll();
+			TaskScheduler::Config config = scheduler->GetConfig();
+			config.telemetry = true;
+			scheduler->StartAll(config);
+			std::atomic_int counter(0);
+			TaskGroup group;
+			for (int i = 0; i < 200; i++)
+				group.Run(Increment, &counter);
+			group.Wait();
+			WorkerStats total = scheduler->GetTotalStats();
+			EXPECT_EQ(200u, total.tasks_run);
+			EXPECT_GT(total.busy_ns + total.idle_ns, 0u);
+			EXPECT_EQ(0, scheduler->PendingCount(TaskScheduler::Priority::Interactive));
+			uint64_t sum = 0;
+			for (int i = 0; i <= scheduler->ThreadCount(); i++)
+				sum += scheduler->GetStats(i).tasks_run;
+			EXPECT_EQ(200u, sum);
+			scheduler->ResetStats();
+			EXPECT_EQ(0u, scheduler->GetTotalStats().tasks_run);
+		}
+
+		TEST_F(TaskSchedulerTests, Trace) {
+			scheduler->StartTrace();
+			ParallelFor(0, 1000, 10, [](int) { std::this_thread::sleep_for(std::chrono::microseconds(1)); });
+			scheduler->StopTrace();
+			std::ostringstream trace;
+			scheduler->WriteTrace(trace);
+			std::string json = trace.str();
+			EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+			EXPECT_NE(std::string::npos, json.find("\"name\":\"task\",\"ph\":\"X\""));
+			EXPECT_NE(std::string::npos, json.find("\"name\":\"queue depth\",\"ph\":\"C\""));
+			EXPECT_NE(std::string::npos, json.find("\"worker 3\""));
+			EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+			// the events are written once
+			std::ostringstream empty;
+			scheduler->WriteTrace(empty);
+			EXPECT_EQ(std::string::npos, empty.str().find("\"ph\":\"X\""));
+		}
+	}
+}